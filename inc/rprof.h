@@ -50,6 +50,15 @@ typedef struct ProfilerScope
 
 } ProfilerScope;
 
+typedef struct ProfilerScopeDesc
+{
+	const char*			m_name;
+	const char*			m_file;
+	uint32_t			m_line;
+	uint32_t			m_id;
+
+} ProfilerScopeDesc;
+
 typedef struct ProfilerThread
 {
 	uint64_t			m_threadID;
@@ -73,14 +82,103 @@ typedef struct ProfilerFrame
 	uint32_t			m_numScopesStats;
 	ProfilerScope*		m_scopesStats;
 	ProfilerScopeStats*	m_scopeStatsInfo;
+	uint32_t			m_clockSource;
 
 } ProfilerFrame;
 
+typedef struct ProfilerFrameIndex
+{
+	uint64_t			m_offset;		/* offset of compressed frame data in capture file */
+	uint64_t			m_startTime;
+	uint64_t			m_endTime;
+	uint32_t			m_size;			/* compressed frame data size, in bytes */
+	uint32_t			m_numScopes;
+	uint32_t			m_numThreads;
+	uint32_t			m_reserved;
+
+} ProfilerFrameIndex;
+
+#ifndef RPROF_SUMMARY_SCOPES_MAX
+#define RPROF_SUMMARY_SCOPES_MAX	8
+#endif
+
+typedef struct ProfilerSummaryScope
+{
+	const char*			m_name;
+	uint64_t			m_exclusiveTime;	/* total for all scopes with this name */
+	uint32_t			m_occurences;
+
+} ProfilerSummaryScope;
+
+typedef struct ProfilerFrameSummary
+{
+	uint64_t				m_startTime;
+	uint64_t				m_endTime;
+	uint64_t				m_CPUFrequency;
+	uint32_t				m_numScopes;
+	uint32_t				m_numThreads;
+	uint32_t				m_maxDepth;
+	uint32_t				m_numTopScopes;
+	ProfilerSummaryScope	m_topScopes[RPROF_SUMMARY_SCOPES_MAX];	/* by exclusive time, descending */
+
+} ProfilerFrameSummary;
+
+/* Scope with a distinct chain of parent scopes, aggregated over frames with rprofAddToCallTree */
+typedef struct ProfilerCallPath
+{
+	const char*			m_name;
+	uint32_t			m_parent;			/* index of parent path, RPROF_CALL_PATH_ROOT for top level scopes */
+	uint32_t			m_depth;			/* 0 for top level scopes */
+	uint64_t			m_inclusiveTime;	/* total of all scopes on the path, see rprofGetCallPaths for clock frequency */
+	uint64_t			m_exclusiveTime;
+	uint32_t			m_occurences;
+
+} ProfilerCallPath;
+
+#define RPROF_CALL_PATH_ROOT		0xffffffff
+
+/* Scope compared between two call trees with rprofDiffCallTrees. Values are per frame averages, */
+/* times are in milliseconds. Index 0 is the baseline tree, index 1 the compared one. */
+typedef struct ProfilerDiffScope
+{
+	const char*			m_name;
+	uint32_t			m_path[2];			/* call path in each tree, RPROF_CALL_PATH_ROOT if not present or matched by name */
+	double				m_inclusiveTime[2];
+	double				m_exclusiveTime[2];
+	double				m_occurences[2];
+
+} ProfilerDiffScope;
+
+/* Matching of scopes by rprofDiffCallTrees */
+#define RPROF_DIFF_CALL_PATH		0	/* equal chains of scope names */
+#define RPROF_DIFF_NAME				1	/* equal scope names, inclusive times of recursive scopes are counted at each level */
+
+/* Compression levels of rprofSave and rprofStartRecording */
+#define RPROF_COMPRESSION_FAST		0	/* faster save, larger data */
+#define RPROF_COMPRESSION_DEFAULT	1
+#define RPROF_COMPRESSION_HIGH		2	/* LZ4 HC, much slower save, smallest data. Needs RPROF_LZ4_HC, see rprof_config.h */
+
+/* Capture file opened with rprofOpenCapture */
+typedef struct ProfilerCapture ProfilerCapture;
+
+/* Reusable memory for loaded frames, created with rprofCreateFrameArena */
+typedef struct ProfilerFrameArena ProfilerFrameArena;
+
+/* Scopes of any number of frames aggregated by call path, created with rprofCreateCallTree */
+typedef struct ProfilerCallTree ProfilerCallTree;
+
+/* Called by exporters with chunks of output, returns non zero on success. */
+typedef int (*ProfilerWriteCallback)(const void* _data, size_t _size, void* _userData);
+
+/* Called by rprofProcessCaptureFrames for each loaded frame, frame data is valid only during the call. */
+/* _worker is index of the calling worker thread, below number of workers. */
+typedef void (*ProfilerFrameCallback)(ProfilerFrame* _data, uint32_t _frame, uint32_t _worker, void* _userData);
+
 /*--------------------------------------------------------------------------
  * API
  *------------------------------------------------------------------------*/
 
-	/* Initialize profiling library. */
+	/* Initialize profiling library. Selects and calibrates the clock, should be called before other threads read it. */
 	void rprofInit();
 
 	/* Shut down profiling library and release all resources. */
@@ -96,20 +194,27 @@ typedef struct ProfilerFrame
 	/* @param[in] _threadID - ID of thread to register, 0 for current thread. */
 	void rprofRegisterThread(const char* _name, uint64_t _threadID = 0);
 
-	/* Unregisters thread name and releases name string. */
+	/* Unregisters thread name and releases name string. When called for the current thread, its capture */
+	/* buffer is released as well and reused by threads started later, same as on thread exit. */
 	/* @param[in] _threadID - thread ID */
 	void rprofUnregisterThread(uint64_t _threadID);
 
 	/* Must be called once per frame at the frame start */
 	void rprofBeginFrame();
 
-	/* Begins a profiling scope/block. */
+	/* Begins a profiling scope/block. Name is hashed on every call and each distinct name takes a call site */
+	/* until shut down, names should come from a small set. Prefer rprofBeginScopeDesc where possible. */
 	/* @param[in] _file - name of source file */
 	/* @param[in] _line - line of source file */
 	/* @param[in] _name - name of the scope */
 	/* @returns scope handle */
 	uintptr_t rprofBeginScope(const char* _file, int _line, const char* _name);
 
+	/* Begins a profiling scope/block described by a call site descriptor. */
+	/* @param[in] _desc - call site descriptor, must stay valid until shut down. ID is assigned on first use, initialize it to 0. */
+	/* @returns scope handle */
+	uintptr_t rprofBeginScopeDesc(ProfilerScopeDesc* _desc);
+
 	/* Stops a profiling scope/block. */
 	/* @param[in] _scopeHandle	- handle of the scope to be closed */
 	void rprofEndScope(uintptr_t _scopeHandle);
@@ -129,12 +234,191 @@ typedef struct ProfilerFrame
 	/* @returns non zero on success */
 	int rprofGetFrame(ProfilerFrame* _data);
 
-	/* Saves profiler data to a binary buffer. */
+	/* Returns number of frames in capture history. History is not updated while profiling is paused. */
+	/* @returns number of frames, at most RPROF_HISTORY_SIZE */
+	uint32_t rprofGetFrameCount();
+
+	/* Fetches data of a frame from capture history. Data stays valid until next rprofGetFrame or rprofGetFrameAt call. */
+	/* @param[in] _index     	- frame index, 0 is the most recent frame */
+	/* @param[out] _data    	- Pointer to frame data structure */
+	/* @returns non zero on success */
+	int rprofGetFrameAt(uint32_t _index, ProfilerFrame* _data);
+
+	/* Starts recording every captured frame to a multi frame capture file (.rprofm). Frames are */
+	/* compressed and written on a background thread, capturing thread only queues a copy. */
+	/* @param[in] _path     	- path of the file to create */
+	/* @param[in] _compression	- compression level, see RPROF_COMPRESSION_* */
+	/* @param[in] _dictionary	- non zero to compress frames with the previous frame as dictionary. Smaller files, */
+	/*                            but loading a frame decompresses up to RPROF_SAVE_DICT_INTERVAL frames. */
+	/* @returns non zero on success */
+	int rprofStartRecording(const char* _path, int _compression = RPROF_COMPRESSION_DEFAULT, int _dictionary = 0);
+
+	/* Stops recording. Blocks until queued frames are written and the file is closed. */
+	void rprofStopRecording();
+
+	/* Returns frame counts for current or last recording. Frames are dropped when writer thread does not keep up. */
+	/* @param[out] _numWritten	- number of frames written to file, can be NULL */
+	/* @param[out] _numDropped	- number of frames dropped, can be NULL */
+	void rprofGetRecordingStats(uint32_t* _numWritten, uint32_t* _numDropped);
+
+	/* Returns number of scopes dropped since rprofInit because profiler ran out of fixed size tables. */
+	/* @param[out] _numNoThread	- scopes of threads started while RPROF_THREADS_MAX profiled threads were alive, can be NULL */
+	/* @param[out] _numNoCallsite	- scopes of new call sites or dynamic names once RPROF_CALLSITES_MAX were in use, can be NULL */
+	/* @param[out] _numFull		- scopes over RPROF_THREAD_SCOPES_MAX per thread or RPROF_SCOPES_MAX per frame, can be NULL */
+	void rprofGetDroppedScopes(uint32_t* _numNoThread, uint32_t* _numNoCallsite, uint32_t* _numFull);
+
+	/* Reads frame table of a multi frame capture file (.rprofm). Frame table is read from the end of the */
+	/* file, files without one (legacy format or interrupted recording) are scanned frame by frame. */
+	/* @param[in] _path          	- path of the capture file */
+	/* @param[out] _index        	- frame table. User is responsible to release memory using rprofReleaseFrameIndex. */
+	/* @param[out] _clockFrequency	- clock frequency of frame times, can be NULL */
+	/* @returns number of frames, 0 for failure */
+	uint32_t rprofLoadFrameIndex(const char* _path, ProfilerFrameIndex** _index, uint64_t* _clockFrequency);
+
+	/* Releases frame table loaded with rprofLoadFrameIndex. */
+	/* @param[in] _index          - frame table to be released */
+	void rprofReleaseFrameIndex(ProfilerFrameIndex* _index);
+
+	/* Opens a single (.rprof) or multi frame (.rprofm) capture file. File is memory mapped where supported, */
+	/* frame table and frame data are used in place and frames are decompressed only when loaded. */
+	/* @param[in] _path          	- path of the capture file */
+	/* @returns capture handle, NULL for failure. User is responsible to close it using rprofCloseCapture. */
+	ProfilerCapture* rprofOpenCapture(const char* _path);
+
+	/* Closes capture file. Frame table and frame data pointers of the capture become invalid. */
+	/* @param[in] _capture        - capture to be closed */
+	void rprofCloseCapture(ProfilerCapture* _capture);
+
+	/* Returns number of frames in a capture file. */
+	uint32_t rprofGetCaptureFrameCount(ProfilerCapture* _capture);
+
+	/* Returns frame table of a capture file, one entry per frame. */
+	const ProfilerFrameIndex* rprofGetCaptureFrameIndex(ProfilerCapture* _capture);
+
+	/* Returns clock frequency of frame times in a capture file. */
+	uint64_t rprofGetCaptureClockFrequency(ProfilerCapture* _capture);
+
+	/* Returns compressed data of a frame, as written by rprofSave. Frames of */
+	/* recorded captures share strings with earlier frames and can be compressed */
+	/* with previous frame as dictionary, rprofLoad of such data leaves these */
+	/* names empty or fails, use rprofLoadCaptureFrame instead. */
+	/* @param[in] _capture        - capture file */
+	/* @param[in] _frame          - frame index */
+	/* @param[out] _size          - size of frame data, in bytes, can be NULL */
+	/* @returns pointer to frame data, NULL for invalid frame index */
+	const void* rprofGetCaptureFrameData(ProfilerCapture* _capture, uint32_t _frame, size_t* _size);
+
+	/* Loads a frame from a capture file, resolving strings shared by frames. Last decompressed frame is */
+	/* kept by the capture for frames using it as dictionary, this function is not thread safe. */
+	/* @param[in] _capture        - capture file */
+	/* @param[in] _frame          - frame index */
+	/* @param[out] _data          - frame data. User is responsible to release memory using rprofRelease. */
+	/* @returns non zero on success */
+	int rprofLoadCaptureFrame(ProfilerCapture* _capture, uint32_t _frame, ProfilerFrame* _data);
+
+	/* Loads a frame from a capture file to arena memory, see rprofLoadToArena. Last decompressed frame is */
+	/* kept by the arena, loading from one capture to different arenas is thread safe. */
+	/* @param[in] _capture        - capture file */
+	/* @param[in] _frame          - frame index */
+	/* @param[out] _data          - frame data, must not be released with rprofRelease */
+	/* @param[in] _arena          - arena holding frame data */
+	/* @returns non zero on success */
+	int rprofLoadCaptureFrameToArena(ProfilerCapture* _capture, uint32_t _frame, ProfilerFrame* _data, ProfilerFrameArena* _arena);
+
+	/* Loads frames of a capture file on worker threads and calls _callback for each of them. Workers take */
+	/* groups of consecutive frames, idle workers steal groups from busy ones. Calling thread is worker 0, */
+	/* function returns once all frames are processed. Frames are in no particular order, results should be */
+	/* gathered per worker and merged after the call. Platforms without thread support use one worker. */
+	/* @param[in] _capture        - capture file */
+	/* @param[in] _callback       - called for each loaded frame, concurrently from different workers */
+	/* @param[in] _userData       - passed to _callback */
+	/* @param[in] _numWorkers     - number of workers, including calling thread */
+	/* @param[in] _firstFrame     - first frame processed, frames before it are not loaded */
+	/* @param[in] _numFrames      - number of frames processed, clamped to end of capture */
+	/* @returns number of frames processed, frames failing to load are skipped */
+	uint32_t rprofProcessCaptureFrames(ProfilerCapture* _capture, ProfilerFrameCallback _callback, void* _userData, uint32_t _numWorkers, uint32_t _firstFrame = 0, uint32_t _numFrames = 0xffffffff);
+
+	/* Creates call tree for aggregating scopes of frames by call path. */
+	/* @returns call tree, destroy with rprofDestroyCallTree */
+	ProfilerCallTree* rprofCreateCallTree(void);
+
+	/* Destroys call tree. */
+	/* @param[in] _tree           - call tree to destroy */
+	void rprofDestroyCallTree(ProfilerCallTree* _tree);
+
+	/* Removes all call paths from call tree, memory is kept for next frames. */
+	/* @param[in] _tree           - call tree */
+	void rprofClearCallTree(ProfilerCallTree* _tree);
+
+	/* Adds scopes of a frame to call tree. Parent of a scope is the closest scope one level up on the same */
+	/* thread containing it, call paths of equal chains of scope names are merged. Aggregating a range of */
+	/* frames is linear in number of their scopes, apart from ordering scopes of each frame by start time. */
+	/* @param[in] _tree           - call tree */
+	/* @param[in] _data           - frame data */
+	/* @param[out] _scopePaths    - call path index of each scope of the frame, can be NULL */
+	void rprofAddToCallTree(ProfilerCallTree* _tree, ProfilerFrame* _data, uint32_t* _scopePaths = 0);
+
+	/* Returns call paths of a call tree, parent paths come before their children. Times are in clock */
+	/* of the first added frame, pointer is valid until call tree is changed. */
+	/* @param[in] _tree           - call tree */
+	/* @param[out] _paths         - call paths */
+	/* @param[out] _frequency     - clock frequency of call path times, can be NULL */
+	/* @returns number of call paths */
+	uint32_t rprofGetCallPaths(ProfilerCallTree* _tree, const ProfilerCallPath** _paths, uint64_t* _frequency);
+
+	/* Returns number of frames added to call tree since it was created or cleared. */
+	/* @param[in] _tree           - call tree */
+	/* @returns number of frames */
+	uint32_t rprofGetCallTreeFrameCount(ProfilerCallTree* _tree);
+
+	/* Compares two call trees, e.g. of two frames or of two frame ranges. Scopes are matched by call path */
+	/* or by name, values are averaged per frame so ranges of different length can be compared. Scopes */
+	/* present in one tree only have zeros for the other. Scopes are sorted by impact, absolute change of */
+	/* exclusive time followed by change of inclusive time. Names are valid while both trees are unchanged. */
+	/* @param[in] _base           - baseline call tree */
+	/* @param[in] _tree           - call tree compared to baseline */
+	/* @param[in] _mode           - scope matching, RPROF_DIFF_CALL_PATH or RPROF_DIFF_NAME */
+	/* @param[out] _scopes        - compared scopes. User is responsible to release memory using rprofReleaseDiff. */
+	/* @returns number of compared scopes */
+	uint32_t rprofDiffCallTrees(ProfilerCallTree* _base, ProfilerCallTree* _tree, uint32_t _mode, ProfilerDiffScope** _scopes);
+
+	/* Releases scopes returned by rprofDiffCallTrees. */
+	/* @param[in] _scopes         - compared scopes */
+	void rprofReleaseDiff(ProfilerDiffScope* _scopes);
+
+	/* Exports call tree in folded stacks format of flame graph tools, one line per call path with */
+	/* ';' separated scope names followed by exclusive time in microseconds. */
+	/* @param[in] _tree           - call tree */
+	/* @param[in] _write          - called with chunks of output */
+	/* @param[in] _userData       - passed to _write */
+	/* @returns non zero on success, 0 if _write failed */
+	int rprofExportFoldedStacks(ProfilerCallTree* _tree, ProfilerWriteCallback _write, void* _userData);
+
+	/* Exports frames of a capture file as Chrome Trace Event JSON, for chrome://tracing, Perfetto and */
+	/* other trace viewers. Frames are loaded and written one at a time through a fixed size buffer, */
+	/* memory use does not depend on capture size. Timestamps are capture clock in microseconds. */
+	/* @param[in] _capture        - capture file */
+	/* @param[in] _firstFrame     - first frame to export */
+	/* @param[in] _numFrames      - number of frames to export, clamped to frames in capture */
+	/* @param[in] _write          - called with chunks of output */
+	/* @param[in] _userData       - passed to _write */
+	/* @returns non zero on success, 0 if _write failed */
+	int rprofExportChromeTrace(ProfilerCapture* _capture, uint32_t _firstFrame, uint32_t _numFrames, ProfilerWriteCallback _write, void* _userData);
+
+	/* Returns buffer size for which rprofSave can not fail and makes no heap allocations. */
+	/* @param[in] _data       - profiler data / single frame capture */
+	/* @param[in] _compression - compression level, see RPROF_COMPRESSION_* */
+	/* @returns buffer size, in bytes */
+	size_t rprofSaveBound(ProfilerFrame* _data, int _compression = RPROF_COMPRESSION_DEFAULT);
+
+	/* Saves profiler data to a binary buffer. Buffers smaller than rprofSaveBound may be enough */
+	/* for the data, working memory is then allocated. */
 	/* @param[in] _data       - profiler data / single frame capture */
 	/* @param[in,out] _buffer - buffer to store data to */
 	/* @param[in] _bufferSize - maximum size of buffer, in bytes */
+	/* @param[in] _compression - compression level, see RPROF_COMPRESSION_* */
 	/* @returns number of bytes written to buffer. 0 for failure. */
-	int rprofSave(ProfilerFrame* _data, void* _buffer, size_t _bufferSize);
+	int rprofSave(ProfilerFrame* _data, void* _buffer, size_t _bufferSize, int _compression = RPROF_COMPRESSION_DEFAULT);
 
 	/* Loads a single frame capture from a binary buffer. */
 	/* @param[in] _data       - [in/out] profiler data / single frame capture. User is responsible to release memory using rprofRelease. */
@@ -142,13 +426,36 @@ typedef struct ProfilerFrame
 	/* @param[in] _bufferSize - maximum size of buffer, in bytes */
 	void rprofLoad(ProfilerFrame* _data, void* _buffer, size_t _bufferSize);
 
+	/* Creates arena for loading frames, memory is reused by subsequent loads. */
+	/* @returns arena, destroy with rprofDestroyFrameArena */
+	ProfilerFrameArena* rprofCreateFrameArena(void);
+
+	/* Destroys arena, frames loaded to it become invalid. */
+	/* @param[in] _arena      - arena to destroy */
+	void rprofDestroyFrameArena(ProfilerFrameArena* _arena);
+
+	/* Loads a single frame capture from a binary buffer to arena memory. Frame data is valid until */
+	/* next load to the same arena, no allocation is made once arena grew to fit loaded frames. */
+	/* @param[in] _data       - [out] profiler data / single frame capture, must not be released with rprofRelease */
+	/* @param[in,out] _buffer - buffer to load data from */
+	/* @param[in] _bufferSize - size of buffer, in bytes */
+	/* @param[in] _arena      - arena holding frame data */
+	void rprofLoadToArena(ProfilerFrame* _data, void* _buffer, size_t _bufferSize, ProfilerFrameArena* _arena);
+
 	/* Loads a only time in miliseconds for a single frame capture from a binary buffer. */
 	/* @param[in] _time       - [in/out] frame timne in ms. */
 	/* @param[in,out] _buffer - buffer to store data to */
 	/* @param[in] _bufferSize - maximum size of buffer, in bytes */
 	void rprofLoadTimeOnly(float* _time, void* _buffer, size_t _bufferSize);
 
-	/* Releases resources for a single frame capture. Only valid for data loaded with rprofLoad. */
+	/* Reads frame summary stored uncompressed in front of frame data, no decompression is done. */
+	/* @param[out] _summary       - frame summary, scope names point into _buffer */
+	/* @param[in] _buffer         - frame data, as written by rprofSave */
+	/* @param[in] _bufferSize     - size of frame data, in bytes */
+	/* @returns non zero on success, 0 for frames saved without summary */
+	int rprofLoadSummary(ProfilerFrameSummary* _summary, const void* _buffer, size_t _bufferSize);
+
+	/* Releases resources for a single frame capture. Only valid for data loaded with rprofLoad or rprofLoadCaptureFrame. */
 	/* @param[in] _data       - data to be released */
 	void rprofRelease(ProfilerFrame* _data);
 	
@@ -160,6 +467,10 @@ typedef struct ProfilerFrame
 	/* @returns CPU frequency. */
 	uint64_t rprofGetClockFrequency();
 
+	/* Returns source of the CPU clock, see rprofGetClockSourceName. */
+	/* @returns clock source identifier. */
+	uint8_t rprofGetClockSource();
+
 	/* Calculates miliseconds from CPU clock. */
 	/* @param[in] _clock       - data to be released */
 	/* @param[in] _frequency   - data to be released */
@@ -171,6 +482,11 @@ typedef struct ProfilerFrame
 	/* @returns platform name as string. */
 	const char* rprofGetPlatformName(uint8_t _platformID);
 
+	/* Returns name of the clock source. */
+	/* @param[in] _clockSource - clock source identifier */
+	/* @returns clock source name as string. */
+	const char* rprofGetClockSourceName(uint8_t _clockSource);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -186,6 +502,11 @@ struct rprofScoped
 		m_scope = rprofBeginScope(_file, _line, _name);
 	}
 
+	rprofScoped(ProfilerScopeDesc* _desc)
+	{
+		m_scope = rprofBeginScopeDesc(_desc);
+	}
+
 	~rprofScoped()
 	{
 		rprofEndScope(m_scope);
@@ -200,14 +521,20 @@ struct rprofScoped
 #define RPROF_CONCAT2(_x, _y) _x ## _y
 #define RPROF_CONCAT(_x, _y) RPROF_CONCAT2(_x, _y)
 
+/* RPROF_SCOPE name must be a string literal, it is stored once per call site and does not compile otherwise. */
+/* Use RPROF_SCOPE_DYNAMIC for names that change between executions, like variables or function results. */
+/* Lambda gives each call site its own descriptor while keeping the macro a single declaration. */
 #define RPROF_INIT()				rprofInit()
-#define RPROF_SCOPE(x, ...)			rprofScoped RPROF_CONCAT(profileScope,__LINE__)(__FILE__, __LINE__, x)
+#define RPROF_SCOPE(x, ...)			rprofScoped RPROF_CONCAT(profileScope,__LINE__)([]() -> ProfilerScopeDesc* { \
+										static ProfilerScopeDesc desc = { "" x "", __FILE__, __LINE__, 0 }; return &desc; }())
+#define RPROF_SCOPE_DYNAMIC(x)		rprofScoped RPROF_CONCAT(profileScope,__LINE__)(__FILE__, __LINE__, x)
 #define RPROF_BEGIN_FRAME()			rprofBeginFrame()
 #define RPROF_REGISTER_THREAD(n)	rprofRegisterThread(n)
 #define RPROF_SHUTDOWN()			rprofShutDown()
 #else
 #define RPROF_INIT()				void()
 #define RPROF_SCOPE(...)			void()
+#define RPROF_SCOPE_DYNAMIC(x)		void()
 #define RPROF_BEGIN_FRAME()			void()
 #define RPROF_REGISTER_THREAD(n)	void()
 #define RPROF_SHUTDOWN()			void()
@@ -8,6 +8,7 @@
 
 #include "rprof.h"
 #include <algorithm>
+#include <vector>
 #include <inttypes.h>
 #include <rapp/3rd/imgui/imgui.h>
 
@@ -452,10 +453,143 @@
 		}
 	} customLessInc;
 
+	/* Call paths shown by call tree mode of rprofDrawStats, children of each path are sorted once */
+	/* per build and sort mode instead of every ImGui frame. */
+	struct ProfilerStatsTree
+	{
+		ProfilerCallTree*		m_callTree;
+		const ProfilerCallPath*	m_paths;
+		uint32_t				m_numPaths;
+		uint64_t				m_frequency;
+		uint64_t				m_totalTime;	/* inclusive time of top level paths */
+		int						m_sortedBy;		/* 0 - exclusive, 1 - inclusive time, -1 - not sorted */
+		std::vector<uint32_t>	m_children;		/* children of each path followed by top level paths */
+		std::vector<uint32_t>	m_firstChild;	/* index in m_children per path and for top level, plus end */
+	};
+
+	struct sortCallPaths {
+		const ProfilerCallPath*	m_paths;
+		int						m_inclusive;
+
+		bool operator()(uint32_t a, uint32_t b) const {
+			return m_inclusive	? (m_paths[a].m_inclusiveTime > m_paths[b].m_inclusiveTime)
+								: (m_paths[a].m_exclusiveTime > m_paths[b].m_exclusiveTime);
+		}
+	};
+
+	/* Prepares call paths for rprofDrawStats, needs to be called again only when call tree changes. */
+	/* _tree       - [out] call tree view */
+	/* _callTree   - call paths of a frame or a range of frames, see rprofAddToCallTree */
+	static inline void rprofStatsTreeBuild(ProfilerStatsTree& _tree, ProfilerCallTree* _callTree)
+	{
+		_tree.m_callTree	= _callTree;
+		_tree.m_numPaths	= rprofGetCallPaths(_callTree, &_tree.m_paths, &_tree.m_frequency);
+		_tree.m_totalTime	= 0;
+		_tree.m_sortedBy	= -1;
+
+		// children grouped by parent, top level paths use slot after last path
+		uint32_t numPaths = _tree.m_numPaths;
+		_tree.m_firstChild.assign(numPaths + 2, 0);
+		for (uint32_t i=0; i<numPaths; ++i)
+		{
+			uint32_t parent = _tree.m_paths[i].m_parent;
+			_tree.m_firstChild[(parent == RPROF_CALL_PATH_ROOT ? numPaths : parent) + 1]++;
+			if (parent == RPROF_CALL_PATH_ROOT)
+				_tree.m_totalTime += _tree.m_paths[i].m_inclusiveTime;
+		}
+
+		for (uint32_t i=0; i<=numPaths; ++i)
+			_tree.m_firstChild[i + 1] += _tree.m_firstChild[i];
+
+		std::vector<uint32_t> next(_tree.m_firstChild.begin(), _tree.m_firstChild.end() - 1);
+		_tree.m_children.resize(numPaths);
+		for (uint32_t i=0; i<numPaths; ++i)
+		{
+			uint32_t parent = _tree.m_paths[i].m_parent;
+			_tree.m_children[next[parent == RPROF_CALL_PATH_ROOT ? numPaths : parent]++] = i;
+		}
+	}
+
+	static inline void rprofStatsTreeSort(ProfilerStatsTree& _tree, int _inclusive)
+	{
+		if (_tree.m_sortedBy == _inclusive)
+			return;
+
+		sortCallPaths order = { _tree.m_paths, _inclusive };
+		for (uint32_t i=0; i<=_tree.m_numPaths; ++i)
+			std::sort(&_tree.m_children[0] + _tree.m_firstChild[i], &_tree.m_children[0] + _tree.m_firstChild[i + 1], order);
+
+		_tree.m_sortedBy = _inclusive;
+	}
+
+	static inline void rprofDrawStatsTreeNode(const ProfilerStatsTree& _tree, uint32_t _path)
+	{
+		const ProfilerCallPath& path = _tree.m_paths[_path];
+		uint32_t firstChild	= _tree.m_firstChild[_path];
+		uint32_t endChild	= _tree.m_firstChild[_path + 1];
+
+		ImGui::TableNextRow();
+		ImGui::TableNextColumn();
+
+		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth;
+		if (firstChild == endChild)
+			flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+		if (!path.m_depth)
+			flags |= ImGuiTreeNodeFlags_DefaultOpen;
+
+		bool open = ImGui::TreeNodeEx((void*)(uintptr_t)_path, flags, "%s", path.m_name);
+		if (ImGui::IsItemClicked())
+		{
+			s_timeSinceStatClicked	= rprofGetClock();
+			s_statClickedName		= path.m_name;
+			s_statClickedLevel		= path.m_depth;
+		}
+
+		ImGui::TableNextColumn();
+		ImGui::Text("%.4f", rprofClock2ms(path.m_inclusiveTime, _tree.m_frequency));
+		ImGui::TableNextColumn();
+		ImGui::Text("%.4f", rprofClock2ms(path.m_exclusiveTime, _tree.m_frequency));
+		ImGui::TableNextColumn();
+		ImGui::Text("%u", path.m_occurences);
+		ImGui::TableNextColumn();
+		ImGui::Text("%2.2f %%", _tree.m_totalTime ? 100.0f * float(path.m_inclusiveTime) / float(_tree.m_totalTime) : 0.0f);
+
+		if (open && (firstChild != endChild))
+		{
+			for (uint32_t i=firstChild; i<endChild; ++i)
+				rprofDrawStatsTreeNode(_tree, _tree.m_children[i]);
+			ImGui::TreePop();
+		}
+	}
+
+	static inline void rprofDrawStatsTree(ProfilerStatsTree& _tree, int _inclusive)
+	{
+		rprofStatsTreeSort(_tree, _inclusive);
+
+		ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+		if (!ImGui::BeginTable("CallTree", 5, flags))
+			return;
+
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Incl. ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Excl. ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_WidthFixed, 50.0f);
+		ImGui::TableSetupColumn("Of total", ImGuiTableColumnFlags_WidthFixed, 60.0f);
+		ImGui::TableHeadersRow();
+
+		for (uint32_t i=_tree.m_firstChild[_tree.m_numPaths]; i<_tree.m_firstChild[_tree.m_numPaths + 1]; ++i)
+			rprofDrawStatsTreeNode(_tree, _tree.m_children[i]);
+
+		ImGui::EndTable();
+	}
+
 	/* Draws a frame capture statistics using ImGui. */
 	/* NB: frame data **MUST** be processed (done in rprofLoad) before using this function. */
 	/* _data       - [in/out] profiler data / single frame capture. User is responsible to release memory using rprofRelease */
-	static inline void rprofDrawStats(ProfilerFrame* _data, bool _multi = false)
+	/* _tree       - call paths for call tree mode, e.g. of a range of frames. When NULL call paths of _data */
+	/*               are aggregated once per frame. */
+	static inline void rprofDrawStats(ProfilerFrame* _data, bool _multi = false, ProfilerStatsTree* _tree = 0)
 	{
 		ImGui::SetNextWindowPos(ImVec2(912.0f, _multi ? 150.0f : 6.0f), ImGuiCond_FirstUseEver);
 		ImGui::SetNextWindowSize(ImVec2(600.0f, 812.0f), ImGuiCond_FirstUseEver);
@@ -472,17 +606,58 @@
 		float deltaTime = rprofClock2ms(_data->m_endtime - _data->m_startTime, _data->m_CPUFrequency);
 
 		static int exclusive = 0;
+		static int callTree = 0;
 		ImGui::Text("Sort by:  ");
 		ImGui::SameLine();
 		ImGui::RadioButton("Exclusive time", &exclusive, 0);
 		ImGui::SameLine();
 		ImGui::RadioButton("Inclusive time", &exclusive, 1);
+		ImGui::Text("View:     ");
+		ImGui::SameLine();
+		ImGui::RadioButton("Flat", &callTree, 0);
+		ImGui::SameLine();
+		ImGui::RadioButton("Call tree", &callTree, 1);
 		ImGui::Separator();
 
-		if (exclusive == 0)
-			std::sort(&_data->m_scopesStats[0], &_data->m_scopesStats[_data->m_numScopesStats], customLessExc);
-		else
-			std::sort(&_data->m_scopesStats[0], &_data->m_scopesStats[_data->m_numScopesStats], customLessInc);
+		// frame is identified by its scopes, stats are sorted and call paths aggregated once per frame
+		uint64_t frame[4] = { (uint64_t)(uintptr_t)_data->m_scopes, _data->m_numScopes, _data->m_startTime, _data->m_endtime };
+
+		if (callTree == 1)
+		{
+			static ProfilerStatsTree frameTree;
+			static uint64_t treeFrame[4] = { 0, 0, 0, 0 };
+
+			if (!_tree)
+			{
+				if (!frameTree.m_callTree)
+					frameTree.m_callTree = rprofCreateCallTree();
+
+				if (memcmp(frame, treeFrame, sizeof(frame)) != 0)
+				{
+					rprofClearCallTree(frameTree.m_callTree);
+					rprofAddToCallTree(frameTree.m_callTree, _data);
+					rprofStatsTreeBuild(frameTree, frameTree.m_callTree);
+					memcpy(treeFrame, frame, sizeof(frame));
+				}
+				_tree = &frameTree;
+			}
+
+			rprofDrawStatsTree(*_tree, exclusive);
+			ImGui::End();
+			return;
+		}
+
+		static uint64_t sortedFrame[4] = { 0, 0, 0, 0 };
+		static int sortedBy = -1;
+		if ((memcmp(frame, sortedFrame, sizeof(frame)) != 0) || (sortedBy != exclusive))
+		{
+			if (exclusive == 0)
+				std::sort(&_data->m_scopesStats[0], &_data->m_scopesStats[_data->m_numScopesStats], customLessExc);
+			else
+				std::sort(&_data->m_scopesStats[0], &_data->m_scopesStats[_data->m_numScopesStats], customLessInc);
+			memcpy(sortedFrame, frame, sizeof(frame));
+			sortedBy = exclusive;
+		}
 
 		const ImVec2 p = ImGui::GetCursorScreenPos();
 		const ImVec2 s = ImGui::GetWindowSize();
@@ -594,4 +769,146 @@
 		ImGui::End();
 	}
 
+	/* Draws rows of scopes compared with rprofDiffCallTrees, changes of time are red when slower. */
+	/* _scopes     - compared scopes, sorted by impact */
+	/* _numScopes  - number of compared scopes */
+	/* _callTrees  - baseline and compared call trees, shows call paths on hover and selects scope level on click. Can be NULL. */
+	static inline void rprofDrawDiffTable(const ProfilerDiffScope* _scopes, uint32_t _numScopes, ProfilerCallTree** _callTrees = 0)
+	{
+		ImGuiTableFlags flags = ImGuiTableFlags_BordersV | ImGuiTableFlags_BordersOuterH | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY;
+		if (!ImGui::BeginTable("Diff", 6, flags))
+			return;
+
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Scope", ImGuiTableColumnFlags_WidthStretch);
+		ImGui::TableSetupColumn("Base excl.", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Excl. ms", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Excl. delta", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Incl. delta", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableSetupColumn("Count delta", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+		ImGui::TableHeadersRow();
+
+		const ImVec4 slower(1.0f, 0.35f, 0.35f, 1.0f);
+		const ImVec4 faster(0.35f, 1.0f, 0.35f, 1.0f);
+
+		for (uint32_t i=0; i<_numScopes; ++i)
+		{
+			const ProfilerDiffScope& scope = _scopes[i];
+			float exclusiveDelta = float(scope.m_exclusiveTime[1] - scope.m_exclusiveTime[0]);
+			float inclusiveDelta = float(scope.m_inclusiveTime[1] - scope.m_inclusiveTime[0]);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::PushID(int(i));
+			ImGui::Selectable(scope.m_name, false, ImGuiSelectableFlags_SpanAllColumns);
+			ImGui::PopID();
+
+			// call path of scopes matched by path, from whichever tree has it
+			int tree = scope.m_path[1] != RPROF_CALL_PATH_ROOT ? 1 : 0;
+			const ProfilerCallPath* paths = 0;
+			if (_callTrees && (scope.m_path[tree] != RPROF_CALL_PATH_ROOT))
+				rprofGetCallPaths(_callTrees[tree], &paths, 0);
+
+			if (ImGui::IsItemClicked())
+			{
+				s_timeSinceStatClicked	= rprofGetClock();
+				s_statClickedName		= scope.m_name;
+				s_statClickedLevel		= paths ? paths[scope.m_path[tree]].m_depth : 0;
+			}
+
+			if (paths && ImGui::IsItemHovered())
+			{
+				std::vector<uint32_t> stack;
+				for (uint32_t path=scope.m_path[tree]; path!=RPROF_CALL_PATH_ROOT; path=paths[path].m_parent)
+					stack.push_back(path);
+
+				ImGui::BeginTooltip();
+				for (size_t j=stack.size(); j--;)
+					ImGui::Text("%*s%s", int(paths[stack[j]].m_depth * 2), "", paths[stack[j]].m_name);
+				ImGui::EndTooltip();
+			}
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", scope.m_exclusiveTime[0]);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.4f", scope.m_exclusiveTime[1]);
+			ImGui::TableNextColumn();
+			ImGui::TextColored(exclusiveDelta > 0.0f ? slower : faster, "%+.4f", exclusiveDelta);
+			ImGui::TableNextColumn();
+			ImGui::TextColored(inclusiveDelta > 0.0f ? slower : faster, "%+.4f", inclusiveDelta);
+			ImGui::TableNextColumn();
+			ImGui::Text("%+.0f", scope.m_occurences[1] - scope.m_occurences[0]);
+		}
+
+		ImGui::EndTable();
+	}
+
+	static inline void rprofDrawDiffFrameInfo(const char* _title, ProfilerFrame* _data)
+	{
+		ImGui::TextColored(ImVec4(0.0f, 1.0f, 1.0f, 1.0f), "%s", _title);
+		ImGui::Text("Frame time: %.4f ms", rprofClock2ms(_data->m_endtime - _data->m_startTime, _data->m_CPUFrequency));
+		ImGui::Text("Scopes: %u, threads: %u", _data->m_numScopes, _data->m_numThreads);
+	}
+
+	/* Draws differences between a baseline frame and another frame side by side using ImGui. Scopes */
+	/* are matched by call path or by name, frames are compared again only when one of them changes. */
+	/* NB: frame data **MUST** be processed (done in rprofLoad) before using this function. */
+	/* _base       - baseline frame */
+	/* _data       - frame compared to baseline */
+	static inline void rprofDrawFrameDiff(ProfilerFrame* _base, ProfilerFrame* _data, bool _multi = false)
+	{
+		ImGui::SetNextWindowPos(ImVec2(1518.0f, _multi ? 150.0f : 6.0f), ImGuiCond_FirstUseEver);
+		ImGui::SetNextWindowSize(ImVec2(600.0f, 812.0f), ImGuiCond_FirstUseEver);
+
+		ImGui::Begin("Frame diff");
+
+		static int byName = 0;
+		ImGui::Text("Match by:  ");
+		ImGui::SameLine();
+		ImGui::RadioButton("Call path", &byName, 0);
+		ImGui::SameLine();
+		ImGui::RadioButton("Name", &byName, 1);
+		ImGui::Separator();
+
+		if (ImGui::BeginTable("Frames", 2, ImGuiTableFlags_BordersInnerV))
+		{
+			ImGui::TableNextColumn();
+			rprofDrawDiffFrameInfo("Baseline", _base);
+			ImGui::TableNextColumn();
+			rprofDrawDiffFrameInfo("Current", _data);
+			ImGui::EndTable();
+		}
+		ImGui::Separator();
+
+		// frames are identified by their scopes, same as in rprofDrawStats
+		uint64_t frames[8] = {	(uint64_t)(uintptr_t)_base->m_scopes, _base->m_numScopes, _base->m_startTime, _base->m_endtime,
+								(uint64_t)(uintptr_t)_data->m_scopes, _data->m_numScopes, _data->m_startTime, _data->m_endtime };
+
+		static ProfilerCallTree*	callTrees[2] = { 0, 0 };
+		static ProfilerDiffScope*	scopes = 0;
+		static uint32_t				numScopes = 0;
+		static uint64_t				diffFrames[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+		static int					diffByName = -1;
+
+		if ((memcmp(frames, diffFrames, sizeof(frames)) != 0) || (diffByName != byName))
+		{
+			ProfilerFrame* data[2] = { _base, _data };
+			for (int i=0; i<2; ++i)
+			{
+				if (!callTrees[i])
+					callTrees[i] = rprofCreateCallTree();
+				rprofClearCallTree(callTrees[i]);
+				rprofAddToCallTree(callTrees[i], data[i]);
+			}
+
+			rprofReleaseDiff(scopes);
+			numScopes = rprofDiffCallTrees(callTrees[0], callTrees[1], byName ? RPROF_DIFF_NAME : RPROF_DIFF_CALL_PATH, &scopes);
+			memcpy(diffFrames, frames, sizeof(frames));
+			diffByName = byName;
+		}
+
+		rprofDrawDiffTable(scopes, numScopes, callTrees);
+		ImGui::End();
+	}
+
 #endif // RPROF_DRAW_H
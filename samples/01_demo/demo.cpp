@@ -30,7 +30,7 @@ static void func(int level=1)
 
 	scopeName[4] = '0' + (char)level;
 
-	RPROF_SCOPE(scopeName);
+	RPROF_SCOPE_DYNAMIC(scopeName);
 	busyCPU();
 	if (level < 5)
 	{
@@ -122,25 +122,13 @@ struct rprofApp : public rapp::App
 			data2.m_CPUFrequency = 0;
 		}
 
-		// Example of writing multi-frame data
+		// Example of writing multi-frame data, frames are written on a
+		// background thread until recording is stopped
 
 		/*
-		static bool headerWritten = false;
-		FILE* file = 0;
-		if (!headerWritten)
-		{
-			uint32_t sig = 0x23232323;
-			file = fopen("capture.rprofm", "wb");
-			fwrite(&sig, 1, 4, file);
-			fclose(file);
-			headerWritten = true;
-		}
-
-		uint32_t size = rprofSave(&data, buffer, 10 * 1024);
-		file = fopen("capture.rprofm", "ab");
-		fwrite(&size, 4, 1, file);
-		fwrite(buffer, 1, size, file);
-		fclose(file);
+		static bool recording = false;
+		if (!recording)
+			recording = rprofStartRecording("capture.rprofm") != 0;
 		*/
 	}
 	
@@ -7,9 +7,37 @@
 #define RPROF_CONFIG_H
 
 #define RPROF_SCOPES_MAX            (16*1024)
-#define RPROF_TEXT_MAX			    (1024*1024)
+#define RPROF_CALLSITES_MAX			(4*1024)
 #define RPROF_DRAW_THREADS_MAX	    (1024)
 
+/*--------------------------------------------------------------------------
+ * Per thread capture buffers, scope ring size must be a power of two.
+ * Ring is drained once per frame, RPROF_SCOPES_MAX entries let a single
+ * thread fill a whole frame.
+ * Captured scopes store thread, level and call site in 8, 8 and 16 bits.
+ * Buffers of exited threads are reused, RPROF_THREADS_MAX limits number of
+ * threads profiled at the same time.
+ *------------------------------------------------------------------------*/
+#define RPROF_THREADS_MAX			(256)
+#define RPROF_THREAD_SCOPES_MAX		RPROF_SCOPES_MAX
+#define RPROF_THREAD_DEPTH_MAX		(64)
+
+/*--------------------------------------------------------------------------
+ * Scopes per captured frame with times that do not fit 32bit offsets
+ *------------------------------------------------------------------------*/
+#define RPROF_WIDE_SCOPES_MAX		(1024)
+
+/*--------------------------------------------------------------------------
+ * Number of most recent frames kept in capture history, at least 1
+ *------------------------------------------------------------------------*/
+#define RPROF_HISTORY_SIZE			(16)
+
+/*--------------------------------------------------------------------------
+ * Frames waiting for the recording writer thread, frames captured while
+ * queue is full are dropped
+ *------------------------------------------------------------------------*/
+#define RPROF_RECORDING_QUEUE_SIZE	(4)
+
 /*--------------------------------------------------------------------------
  * Define to 1 if LZ4 is already statically linked with project using rprof
  *------------------------------------------------------------------------*/
@@ -17,4 +45,36 @@
 
 #define RPROF_LZ4_BUFFER_MAX_SIZE   (16*1024*1024)
 
+/*--------------------------------------------------------------------------
+ * Frame data is compressed in blocks of this size when saving, two blocks
+ * are part of the working memory reported by rprofSaveBound
+ *------------------------------------------------------------------------*/
+#define RPROF_SAVE_BLOCK_SIZE		(16*1024)
+
+/*--------------------------------------------------------------------------
+ * Recorded frames compressed with previous frame as dictionary use this many
+ * bytes from the start of its data. Every RPROF_SAVE_DICT_INTERVAL-th frame
+ * is compressed without dictionary, loading a frame decompresses at most
+ * that many frames.
+ *------------------------------------------------------------------------*/
+#define RPROF_SAVE_DICT_SIZE		(32*1024)
+#define RPROF_SAVE_DICT_INTERVAL	(16)
+
+/*--------------------------------------------------------------------------
+ * LZ4 acceleration used for RPROF_COMPRESSION_FAST, higher is faster
+ *------------------------------------------------------------------------*/
+#define RPROF_LZ4_FAST_ACCELERATION	(8)
+
+/*--------------------------------------------------------------------------
+ * Define to 1 to use LZ4 HC for RPROF_COMPRESSION_HIGH, lz4hc.h and lz4hc.c
+ * of the same LZ4 release must be next to lz4.h. RPROF_COMPRESSION_HIGH is
+ * the same as RPROF_COMPRESSION_DEFAULT otherwise.
+ *------------------------------------------------------------------------*/
+#define RPROF_LZ4_HC				0
+
+/*--------------------------------------------------------------------------
+ * Exporters write output to user callback in chunks of at most this size
+ *------------------------------------------------------------------------*/
+#define RPROF_EXPORT_BUFFER_SIZE	(64*1024)
+
 #endif /* RPROF_CONFIG_H */
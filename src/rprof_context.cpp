@@ -9,34 +9,96 @@
 #include "rprof_context.h"
 #include "rprof_tls.h"
 
+#include <string.h>
+
 extern "C" uint64_t rprofGetClockFrequency();
 
 namespace rprof {
 
+	// Descriptor ID is written under the lock and read without it. Relaxed is
+	// enough, ID is only an index that beginScope validates against m_callsites
+	// and no data is read through it. ProfilerScopeDesc is a C struct, so the
+	// field can not be std::atomic.
+	static inline uint32_t loadCallsiteID(const ProfilerScopeDesc* _desc)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		return *(const volatile uint32_t*)&_desc->m_id;
+#else
+		return __atomic_load_n(&_desc->m_id, __ATOMIC_RELAXED);
+#endif
+	}
+
+	static inline void storeCallsiteID(ProfilerScopeDesc* _desc, uint32_t _id)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		*(volatile uint32_t*)&_desc->m_id = _id;
+#else
+		__atomic_store_n(&_desc->m_id, _id, __ATOMIC_RELAXED);
+#endif
+	}
+
+	// Runs on exiting thread, buffer is recycled by collector on next frame
+	static void releaseThreadBuffer(void* _buffer)
+	{
+		((ProfilerThreadBuffer*)_buffer)->m_released.store(1, std::memory_order_release);
+	}
+
 	ProfilerContext::ProfilerContext()
-		: m_scopesOpen(0)
-		, m_displayScopes(0)
-		, m_frameStartTime(0)
-		, m_frameEndTime(0)
+		: m_numThreadBuffers(0)
+		, m_numFreeThreadBuffers(0)
+		, m_numDroppedNoThread(0)
+		, m_numDroppedNoCallsite(0)
+		, m_numDroppedFull(0)
+		, m_historyHead(0)
+		, m_historyCount(0)
 		, m_thresholdCrossed(false)
 		, m_timeThreshold(0.0f)
 		, m_levelThreshold(0)
 		, m_pauseProfiling(false)
+		, m_numCallsites(0)
 	{
-		m_tlsLevel = tlsAllocate();
-		rprofFreeListCreate(sizeof(ProfilerScope), RPROF_SCOPES_MAX, &m_scopesAllocator);
+		m_tlsBuffer		= tlsAllocate(releaseThreadBuffer);
+		m_frameCapture	= new ProfilerCapturedFrame();
+		m_frameDisplay	= new ProfilerCapturedFrame();
+		m_recorder		= new ProfilerRecorder(this);
 
-		for (int i=0; i<BufferUse::Count; ++i)
-		{
-			m_namesSize[i] = 0;
-			m_namesData[i] = m_namesDataBuffers[i];
-		}
+		for (uint32_t i=0; i<RPROF_HISTORY_SIZE; ++i)
+			m_history[i] = new ProfilerCapturedFrame();
+
+		for (uint32_t i=0; i<RPROF_CALLSITES_MAX; ++i)
+			m_callsites[i].store(0, std::memory_order_relaxed);
+
+		for (uint32_t i=0; i<RPROF_CALLSITES_MAX * 2; ++i)
+			m_dynamicCallsites[i].store(0, std::memory_order_relaxed);
 	}
 
 	ProfilerContext::~ProfilerContext()
 	{
-		rprofFreeListDestroy(&m_scopesAllocator);
-		tlsFree(m_tlsLevel);
+		// stop writer thread first, it reads call sites and thread buffers
+		delete m_recorder;
+
+		// before buffers are deleted, freeing may run exit callbacks on some platforms
+		tlsFree(m_tlsBuffer);
+
+		for (uint32_t i=0; i<m_numThreadBuffers; ++i)
+			delete m_threadBuffers[i];
+
+		for (uint32_t i=0; i<RPROF_CALLSITES_MAX * 2; ++i)
+		{
+			uint32_t callsite = m_dynamicCallsites[i].load(std::memory_order_relaxed);
+			if (!callsite)
+				continue;
+
+			ProfilerScopeDesc* desc = m_callsites[callsite - 1].load(std::memory_order_relaxed);
+			delete[] desc->m_name;
+			delete desc;
+		}
+
+		delete m_frameCapture;
+		delete m_frameDisplay;
+
+		for (uint32_t i=0; i<RPROF_HISTORY_SIZE; ++i)
+			delete m_history[i];
 	}
 
 	void ProfilerContext::setThreshold(float _ms, int _levelThreshold)
@@ -70,6 +132,18 @@ namespace rprof {
 	{
 		ScopedMutexLocker lock(m_mutex);
 		m_threadNames.erase(_threadID);
+
+		// capture buffer can only be released by its owner, other threads keep
+		// it until they exit
+		if (_threadID != getThreadID())
+			return;
+
+		ProfilerThreadBuffer* buffer = (ProfilerThreadBuffer*)tlsGetValue(m_tlsBuffer);
+		if (buffer)
+		{
+			tlsSetValue(m_tlsBuffer, 0);
+			releaseThreadBuffer(buffer);
+		}
 	}
 
 	void ProfilerContext::beginFrame()
@@ -86,38 +160,37 @@ namespace rprof {
 
 		int level = (int)m_levelThreshold - 1;
 
-		uint32_t scopesToRestart = 0;
-
-		m_namesSize[BufferUse::Open] = 0;
-
-		static ProfilerScope scopesDisplay[RPROF_SCOPES_MAX];
-		for (uint32_t i=0; i<m_scopesOpen; ++i)
+		m_frameCapture->reset(frameBeginTime, frameEndTime);
+		for (uint32_t i=0; i<m_numThreadBuffers; ++i)
 		{
-			ProfilerScope* scope = m_scopesCapture[i];
-
-			if (scope->m_start == scope->m_end)
-				scope->m_name = addString(scope->m_name, BufferUse::Open);
+			ProfilerThreadBuffer* buffer = m_threadBuffers[i];
+			if (buffer->m_free)
+				continue;
 
-			scopesDisplay[i] = *scope;
+			// released flag is read first, scopes written before release are collected below
+			bool released = buffer->m_released.load(std::memory_order_acquire) != 0;
+			collectThread(buffer, (uint8_t)i);
 
-			// scope that was not closed, spans frame boundary
-			// keep it for next frame
-			if (scope->m_start == scope->m_end)
-				m_scopesCapture[scopesToRestart++] = scope;
-			else
+			if (released && (buffer->m_tail.load(std::memory_order_relaxed) == buffer->m_head.load(std::memory_order_relaxed)))
 			{
-				rprofFreeListFree(&m_scopesAllocator, scope);
-				scope = &scopesDisplay[i];
+				buffer->m_free = true;
+				m_freeThreadBuffers[m_numFreeThreadBuffers++] = i;
 			}
+		}
+
+		for (uint32_t i=0; i<m_frameCapture->m_numScopes; ++i)
+		{
+			const ProfilerCapturedScope& scope = m_frameCapture->m_scopes[i];
 
 			// did scope cross threshold?
-			if (level == (int)scope->m_level)
+			if (level == (int)scope.m_level)
 			{
-				uint64_t scopeEnd = scope->m_end;
-				if (scope->m_start == scope->m_end)
+				uint64_t scopeStart, scopeEnd;
+				m_frameCapture->getTimes(scope, scopeStart, scopeEnd);
+				if (scope.m_flags & ProfilerCapturedScope::Open)
 					scopeEnd = frameEndTime;
 
-				if (m_timeThreshold <= rprofClock2ms(scopeEnd - scope->m_start, rprofGetClockFrequency()))
+				if (m_timeThreshold <= rprofClock2ms(scopeEnd - scopeStart, rprofGetClockFrequency()))
 					m_thresholdCrossed = true;
 			}
 		}
@@ -127,130 +200,414 @@ namespace rprof {
 		if ((level == -1) && (m_timeThreshold <= prevFrameTime))
 			m_thresholdCrossed = true;
 
-		if (m_thresholdCrossed && !m_pauseProfiling)
+		if (m_pauseProfiling)
+			return;
+
+		if (m_thresholdCrossed)
+			m_frameDisplay->copyFrom(*m_frameCapture);
+
+		m_recorder->push(*m_frameCapture);
+
+		// captured frame goes to history, oldest history frame is recycled for next capture
+		std::swap(m_frameCapture, m_history[m_historyHead]);
+		m_historyHead = (m_historyHead + 1) % RPROF_HISTORY_SIZE;
+		if (m_historyCount < RPROF_HISTORY_SIZE)
+			++m_historyCount;
+	}
+
+	void ProfilerContext::collectThread(ProfilerThreadBuffer* _buffer, uint8_t _lane)
+	{
+		ProfilerOpenScope	open[RPROF_THREAD_DEPTH_MAX];
+		uint32_t			numOpen;
+		uint32_t			head;
+
+		// take a consistent snapshot of open scopes and ring head, retry if
+		// owning thread has modified them in the mean time
+		for (;;)
+		{
+			uint32_t sequence = _buffer->m_sequence.load(std::memory_order_acquire);
+			if (sequence & 1)
+				continue;
+
+			numOpen	= _buffer->m_numOpen.load(std::memory_order_relaxed);
+			head	= _buffer->m_head.load(std::memory_order_relaxed);
+			for (uint32_t i=0; i<numOpen; ++i)
+				open[i] = _buffer->m_open[i];
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (sequence == _buffer->m_sequence.load(std::memory_order_relaxed))
+				break;
+		}
+
+		ProfilerCapturedFrame* frame = m_frameCapture;
+		frame->setLane(_lane, _buffer->m_threadID);
+
+		// closed scopes are released from the ring, scopes closed after frame
+		// end are left for the next frame
+		uint32_t numFull = 0;
+		uint32_t tail = _buffer->m_tail.load(std::memory_order_relaxed);
+		while (tail != head)
 		{
-			std::swap(m_namesData[BufferUse::Capture], m_namesData[BufferUse::Display]);
+			const ProfilerScopeRecord& record = _buffer->m_scopes[tail & (RPROF_THREAD_SCOPES_MAX - 1)];
 
-			for (uint32_t i=0; i<m_scopesOpen; ++i)
-				m_scopesDisplay[i] = scopesDisplay[i];
+			uint32_t size	= 1;
+			uint64_t end	= record.m_start + record.m_duration;
+			if (record.m_duration == s_durationWide)
+			{
+				end		= _buffer->m_scopes[(tail + 1) & (RPROF_THREAD_SCOPES_MAX - 1)].m_start;
+				size	= 2;
+			}
 
-			m_displayScopes		= m_scopesOpen;
-			m_frameStartTime	= frameBeginTime;
-			m_frameEndTime		= frameEndTime;
+			if (end > frame->m_endTime)
+				break;
+
+			if (!frame->addScope(record.m_start, end, record.m_callsite, _lane, (uint8_t)record.m_level, false))
+				++numFull;
+			tail += size;
 		}
+		_buffer->m_tail.store(tail, std::memory_order_release);
+
+		if (numFull)
+			m_numDroppedFull.fetch_add(numFull, std::memory_order_relaxed);
 
-		m_namesSize[BufferUse::Capture] = 0;
-		for (uint32_t i=0; i<scopesToRestart; ++i)
-			m_scopesCapture[i]->m_name = addString(m_scopesCapture[i]->m_name, BufferUse::Capture);
+		// scopes that were not closed span frame boundary, owning thread
+		// keeps them and they will be collected again next frame
+		for (uint32_t i=0; i<numOpen; ++i)
+		{
+			if (open[i].m_start > frame->m_endTime)
+				break;
 
-		m_scopesOpen	= scopesToRestart;
+			frame->addScope(open[i].m_start, open[i].m_start, (uint16_t)open[i].m_callsite, _lane, (uint8_t)i, true);
+		}
 	}
 
-	int ProfilerContext::incLevel()
+	ProfilerThreadBuffer* ProfilerContext::getThreadBuffer()
 	{
-		// may be a first call on this thread
-		void* tl = tlsGetValue(m_tlsLevel);
-		if (!tl)
+		ProfilerThreadBuffer* buffer = (ProfilerThreadBuffer*)tlsGetValue(m_tlsBuffer);
+		if (buffer)
+			return buffer;
+
+		// first scope on this thread, lanes of exited threads are reused first
+		ScopedMutexLocker lock(m_mutex);
+		if (m_numFreeThreadBuffers)
 		{
-			// we'd like to start with -1 but then the ++ operator below
-			// would result in NULL value for tls so we offset by 2
-			tl = (void*)1;
-			tlsSetValue(m_tlsLevel, tl);
+			buffer = m_threadBuffers[m_freeThreadBuffers[--m_numFreeThreadBuffers]];
+			buffer->reuse(getThreadID());
 		}
-		intptr_t threadLevel = (intptr_t)tl - 1;
-		tlsSetValue(m_tlsLevel, (void*)(threadLevel + 2));
-		return (int)threadLevel;
+		else
+		if (m_numThreadBuffers < RPROF_THREADS_MAX)
+		{
+			buffer = new ProfilerThreadBuffer(getThreadID());
+			m_threadBuffers[m_numThreadBuffers++] = buffer;
+		}
+		else
+		{
+			// more than RPROF_THREADS_MAX threads alive and profiled
+			m_numDroppedNoThread.fetch_add(1, std::memory_order_relaxed);
+			return 0;
+		}
+
+		tlsSetValue(m_tlsBuffer, buffer);
+		return buffer;
 	}
 
-	void ProfilerContext::decLevel()
+	static inline bool isDynamicCallsite(const ProfilerScopeDesc* _desc, const char* _file, int _line, const char* _name)
 	{
-		intptr_t threadLevel = (intptr_t)tlsGetValue(m_tlsLevel);
-		--threadLevel;
-		tlsSetValue(m_tlsLevel, (void*)threadLevel);
+		return (_desc->m_line == (uint32_t)_line) && (_desc->m_file == _file) && (strcmp(_desc->m_name, _name) == 0);
 	}
 
-	ProfilerScope* ProfilerContext::beginScope(const char* _file, int _line, const char* _name)
+	ProfilerOpenScope* ProfilerContext::beginScope(const char* _file, int _line, const char* _name)
 	{
-		ProfilerScope* scope = 0;
+		ProfilerThreadBuffer* buffer = getThreadBuffer();
+		if (!buffer)
+			return 0;
+
+		// dynamic names are interned by content, name buffer may change after this call
+		uint32_t hash = 2166136261u;
+		for (const char* c = _name; *c; ++c)
+			hash = (hash ^ (uint8_t)*c) * 16777619u;
+		hash = (hash ^ (uint32_t)_line) * 16777619u;
+
+		// thread cache first, then shared table without lock, lock is taken only to add a name
+		uint32_t& cached = buffer->m_dynamicCache[hash & (s_dynamicCacheSize - 1)];
+		uint32_t callsite = cached;
+		if (!callsite || !isDynamicCallsite(m_callsites[callsite - 1].load(std::memory_order_relaxed), _file, _line, _name))
 		{
-			ScopedMutexLocker lock(m_mutex);
-			if (m_scopesOpen == RPROF_SCOPES_MAX)
+			callsite = findDynamicCallsite(hash, _file, _line, _name, 0);
+			if (!callsite)
+				callsite = addDynamicCallsite(hash, _file, _line, _name);
+
+			if (!callsite)
+			{
+				m_numDroppedNoCallsite.fetch_add(1, std::memory_order_relaxed);
 				return 0;
+			}
+			cached = callsite;
+		}
+
+		return pushScope(buffer, callsite);
+	}
+
+	// Table has twice the slots of call sites, probing always ends at an empty slot
+	uint32_t ProfilerContext::findDynamicCallsite(uint32_t _hash, const char* _file, int _line, const char* _name, uint32_t* _slot)
+	{
+		const uint32_t mask = RPROF_CALLSITES_MAX * 2 - 1;
+		for (uint32_t slot = _hash & mask;; slot = (slot + 1) & mask)
+		{
+			// acquire pairs with release in addDynamicCallsite, descriptor is visible
+			uint32_t callsite = m_dynamicCallsites[slot].load(std::memory_order_acquire);
+			if (!callsite)
+			{
+				if (_slot)
+					*_slot = slot;
+				return 0;
+			}
 
-			scope = (ProfilerScope*)rprofFreeListAlloc(&m_scopesAllocator);
-			m_scopesCapture[m_scopesOpen++] = scope;
+			if (isDynamicCallsite(m_callsites[callsite - 1].load(std::memory_order_relaxed), _file, _line, _name))
+				return callsite;
+		}
+	}
+
+	uint32_t ProfilerContext::addDynamicCallsite(uint32_t _hash, const char* _file, int _line, const char* _name)
+	{
+		ScopedMutexLocker lock(m_mutex);
+
+		// another thread may have added the name in the mean time
+		uint32_t slot;
+		uint32_t callsite = findDynamicCallsite(_hash, _file, _line, _name, &slot);
+		if (callsite)
+			return callsite;
+
+		if (m_numCallsites == RPROF_CALLSITES_MAX)
+			return 0;
+
+		size_t len = strlen(_name);
+		char* name = new char[len + 1];
+		memcpy(name, _name, len + 1);
+
+		ProfilerScopeDesc* desc = new ProfilerScopeDesc;
+		desc->m_name	= name;
+		desc->m_file	= _file;
+		desc->m_line	= (uint32_t)_line;
+		desc->m_id		= 0;
+
+		callsite = addCallsite(desc);
+		m_dynamicCallsites[slot].store(callsite, std::memory_order_release);
+		return callsite;
+	}
+
+	ProfilerOpenScope* ProfilerContext::beginScope(ProfilerScopeDesc* _desc)
+	{
+		// descriptor may carry an ID from previous context, validate it against the table
+		uint32_t callsite = loadCallsiteID(_desc);
+		if (!callsite || (callsite > RPROF_CALLSITES_MAX) || (m_callsites[callsite - 1].load(std::memory_order_relaxed) != _desc))
+			callsite = registerCallsite(_desc);
 
-			scope->m_name		= addString(_name, BufferUse::Capture);
-			scope->m_start		= rprofGetClock();
-			scope->m_end		= scope->m_start;
-			scope->m_threadID	= getThreadID();
-			scope->m_file		= _file;
-			scope->m_line		= _line;
-			scope->m_level		= incLevel();
+		if (!callsite)
+		{
+			m_numDroppedNoCallsite.fetch_add(1, std::memory_order_relaxed);
+			return 0;
 		}
 
+		ProfilerThreadBuffer* buffer = getThreadBuffer();
+		if (!buffer)
+			return 0;
+
+		return pushScope(buffer, callsite);
+	}
+
+	uint32_t ProfilerContext::registerCallsite(ProfilerScopeDesc* _desc)
+	{
+		ScopedMutexLocker lock(m_mutex);
+
+		uint32_t callsite = loadCallsiteID(_desc);
+		if (callsite && (callsite <= m_numCallsites) && (m_callsites[callsite - 1].load(std::memory_order_relaxed) == _desc))
+			return callsite;
+
+		if (m_numCallsites == RPROF_CALLSITES_MAX)
+			return 0;
+
+		return addCallsite(_desc);
+	}
+
+	uint32_t ProfilerContext::addCallsite(ProfilerScopeDesc* _desc)
+	{
+		m_callsites[m_numCallsites].store(_desc, std::memory_order_relaxed);
+		storeCallsiteID(_desc, ++m_numCallsites);
+		return m_numCallsites;
+	}
+
+	ProfilerOpenScope* ProfilerContext::pushScope(ProfilerThreadBuffer* _buffer, uint32_t _callsite)
+	{
+		uint32_t level = _buffer->m_numOpen.load(std::memory_order_relaxed);
+		if (level == RPROF_THREAD_DEPTH_MAX)
+			return 0;
+
+		ProfilerOpenScope* scope = &_buffer->m_open[level];
+
+		_buffer->writeBegin();
+		scope->m_callsite	= _callsite;
+		scope->m_start		= rprofGetClock();
+		_buffer->m_numOpen.store(level + 1, std::memory_order_relaxed);
+		_buffer->writeEnd();
+
 		return scope;
 	}
 
-	void ProfilerContext::endScope(ProfilerScope* _scope)
+	void ProfilerContext::endScope(ProfilerOpenScope* _scope)
 	{
 		if (!_scope)
 			return;
 
-		_scope->m_end = rprofGetClock();
-		decLevel();
-	}
+		uint64_t end = rprofGetClock();
 
-	const char* ProfilerContext::addString(const char* _name, BufferUse _buffer)
-	{
-		char*	nameData = m_namesData[_buffer];
-		int&	nameSize = m_namesSize[_buffer];
+		ProfilerThreadBuffer* buffer = (ProfilerThreadBuffer*)tlsGetValue(m_tlsBuffer);
+		if (!buffer || (_scope < &buffer->m_open[0]) || (_scope >= &buffer->m_open[RPROF_THREAD_DEPTH_MAX]))
+			return;
+
+		uint32_t level		= (uint32_t)(_scope - buffer->m_open);
+		uint32_t head		= buffer->m_head.load(std::memory_order_relaxed);
+		uint64_t duration	= end - _scope->m_start;
+		uint32_t size		= duration < s_durationWide ? 1 : 2;
 
-		char *ret = &nameData[nameSize];
-		while (nameSize < RPROF_TEXT_MAX)
+		// drop the scope if collector did not keep up
+		bool full = (head - buffer->m_tail.load(std::memory_order_acquire)) + size > RPROF_THREAD_SCOPES_MAX;
+		if (full)
+			m_numDroppedFull.fetch_add(1, std::memory_order_relaxed);
+
+		buffer->writeBegin();
+		if (!full)
 		{
-			char c = *_name++;
-			if (c)
-				nameData[nameSize++] = c;
-			else
-				break;
-		}
+			ProfilerScopeRecord& record = buffer->m_scopes[head & (RPROF_THREAD_SCOPES_MAX - 1)];
+			record.m_start		= _scope->m_start;
+			record.m_duration	= size == 1 ? (uint32_t)duration : s_durationWide;
+			record.m_callsite	= (uint16_t)_scope->m_callsite;
+			record.m_level		= (uint16_t)level;
 
-		if (nameSize < RPROF_TEXT_MAX)
-			nameData[nameSize++] = 0;
-		else
-			nameData[RPROF_TEXT_MAX - 1] = 0;
+			if (size == 2)
+				buffer->m_scopes[(head + 1) & (RPROF_THREAD_SCOPES_MAX - 1)].m_start = end;
 
-		return ret;
+			buffer->m_head.store(head + size, std::memory_order_relaxed);
+		}
+		buffer->m_numOpen.store(level, std::memory_order_relaxed);
+		buffer->writeEnd();
 	}
 
 	void ProfilerContext::getFrameData(ProfilerFrame* _data)
 	{
 		ScopedMutexLocker lock(m_mutex);
+		expandFrame(m_frameDisplay, _data, m_scopesExpanded, m_threadsExpanded, 0);
+	}
+
+	uint32_t ProfilerContext::getFrameCount()
+	{
+		ScopedMutexLocker lock(m_mutex);
+		return m_historyCount;
+	}
+
+	bool ProfilerContext::getFrameDataAt(uint32_t _index, ProfilerFrame* _data)
+	{
+		ScopedMutexLocker lock(m_mutex);
+		if (_index >= m_historyCount)
+			return false;
 
-		static ProfilerThread threadData[RPROF_DRAW_THREADS_MAX];
+		uint32_t slot = (m_historyHead + RPROF_HISTORY_SIZE - 1 - _index) % RPROF_HISTORY_SIZE;
+		expandFrame(m_history[slot], _data, m_scopesExpanded, m_threadsExpanded, 0);
+		return true;
+	}
+
+	void ProfilerContext::getFrameData(const ProfilerCapturedFrame* _frame, ProfilerFrame* _data, ProfilerScope* _scopes, ProfilerThread* _threads, std::string* _threadNames)
+	{
+		ScopedMutexLocker lock(m_mutex);
+		expandFrame(_frame, _data, _scopes, _threads, _threadNames);
+	}
 
+	bool ProfilerContext::startRecording(const char* _path, int _compression, bool _dictionary)
+	{
+		return m_recorder->start(_path, _compression, _dictionary);
+	}
+
+	void ProfilerContext::stopRecording()
+	{
+		// not under context lock, writer thread needs it to expand queued frames
+		m_recorder->stop();
+	}
+
+	void ProfilerContext::getRecordingStats(uint32_t* _numWritten, uint32_t* _numDropped)
+	{
+		m_recorder->getStats(_numWritten, _numDropped);
+	}
+
+	void ProfilerContext::getDroppedScopes(uint32_t* _numNoThread, uint32_t* _numNoCallsite, uint32_t* _numFull)
+	{
+		if (_numNoThread)
+			*_numNoThread = m_numDroppedNoThread.load(std::memory_order_relaxed);
+		if (_numNoCallsite)
+			*_numNoCallsite = m_numDroppedNoCallsite.load(std::memory_order_relaxed);
+		if (_numFull)
+			*_numFull = m_numDroppedFull.load(std::memory_order_relaxed);
+	}
+
+	// Thread names are copied to _threadNames when given, otherwise thread data
+	// points to names owned by context
+	void ProfilerContext::expandFrame(const ProfilerCapturedFrame* _frame, ProfilerFrame* _data, ProfilerScope* _scopes, ProfilerThread* _threads, std::string* _threadNames)
+	{
 		uint32_t numThreads = (uint32_t)m_threadNames.size();
 		if (numThreads > RPROF_DRAW_THREADS_MAX)
 			numThreads = RPROF_DRAW_THREADS_MAX;
 
-		_data->m_numScopes		= m_displayScopes;
-		_data->m_scopes			= m_scopesDisplay;
+		// expand captured scopes
+		for (uint32_t i=0; i<_frame->m_numScopes; ++i)
+		{
+			const ProfilerCapturedScope&	cs		= _frame->m_scopes[i];
+			const ProfilerScopeDesc*		desc	= m_callsites[cs.m_callsite - 1].load(std::memory_order_relaxed);
+			ProfilerScope&					scope	= _scopes[i];
+
+			_frame->getTimes(cs, scope.m_start, scope.m_end);
+
+			// clamp scopes crossing frame boundary
+			if (cs.m_flags & ProfilerCapturedScope::Open)
+			{
+				scope.m_end = _frame->m_endTime;
+				if (scope.m_start < _frame->m_startTime)
+					scope.m_start = _frame->m_startTime;
+			}
+
+			scope.m_threadID	= _frame->m_laneThreads[cs.m_lane];
+			scope.m_name		= desc->m_name;
+			scope.m_file		= desc->m_file;
+			scope.m_line		= desc->m_line;
+			scope.m_level		= cs.m_level;
+			scope.m_stats		= 0;
+		}
+
+		_data->m_numScopes		= _frame->m_numScopes;
+		_data->m_scopes			= _scopes;
 		_data->m_numThreads		= numThreads;
-		_data->m_threads		= threadData;
-		_data->m_startTime		= m_frameStartTime;
-		_data->m_endtime		= m_frameEndTime;
-		_data->m_prevFrameTime	= m_frameEndTime - m_frameStartTime;
+		_data->m_threads		= _threads;
+		_data->m_startTime		= _frame->m_startTime;
+		_data->m_endtime		= _frame->m_endTime;
+		_data->m_prevFrameTime	= _frame->m_endTime - _frame->m_startTime;
 		_data->m_CPUFrequency	= rprofGetClockFrequency();
 		_data->m_timeThreshold	= m_timeThreshold;
 		_data->m_levelThreshold	= m_levelThreshold;
 		_data->m_platformID		= getPlatformID();
+		_data->m_clockSource	= rprofGetClockSource();
+		_data->m_numScopesStats	= 0;
+		_data->m_scopesStats	= 0;
+		_data->m_scopeStatsInfo	= 0;
 
 		std::unordered_map<uint64_t, std::string>::iterator it = m_threadNames.begin();
 		for (uint32_t i=0; i<numThreads; ++i)
 		{
-			threadData[i].m_threadID	= it->first;
-			threadData[i].m_name		= it->second.c_str();
+			_threads[i].m_threadID	= it->first;
+			if (_threadNames)
+			{
+				_threadNames[i]		= it->second;
+				_threads[i].m_name	= _threadNames[i].c_str();
+			}
+			else
+				_threads[i].m_name	= it->second.c_str();
 			++it;
 		}
 	}
@@ -9,41 +9,243 @@
 #include "../inc/rprof.h"
 #include "rprof_config.h"
 #include "rprof_mutex.h"
-#include "rprof_freelist.h"
+#include "rprof_recorder.h"
 
 #include <unordered_map>
 #include <string>
+#include <atomic>
+#include <string.h>
 
 namespace rprof {
 
-	class ProfilerContext
+	// Scope that was started but not yet closed, lives on owning thread's stack
+	struct ProfilerOpenScope
 	{
-		enum BufferUse
-		{
-			Capture,
-			Display,
-			Open,
+		uint64_t		m_start;
+		uint32_t		m_callsite;
+	};
+
+	static const uint32_t s_durationWide = 0xffffffff;
+
+	// Per thread cache of dynamic name call sites, must be a power of two
+	static const uint32_t s_dynamicCacheSize = 64;
+
+	// Closed scope, pushed to owning thread's ring buffer. Scopes too long for
+	// 32bit duration are followed by a second record holding the end time.
+	struct ProfilerScopeRecord
+	{
+		uint64_t		m_start;
+		uint32_t		m_duration;
+		uint16_t		m_callsite;
+		uint16_t		m_level;
+	};
 
-			Count
+	// Scope in a captured frame, expanded to ProfilerScope only when frame data
+	// is requested. Times are relative to frame start, scopes that do not fit
+	// keep full times in frame's wide time table and store the index instead.
+	struct ProfilerCapturedScope
+	{
+		enum Flags
+		{
+			Open	= 1,
+			Wide	= 2
 		};
 
+		uint32_t		m_start;
+		uint32_t		m_duration;
+		uint16_t		m_callsite;
+		uint8_t			m_lane;
+		uint8_t			m_level;
+		uint8_t			m_flags;
+	};
+
+	struct ProfilerCapturedFrame
+	{
+		uint64_t				m_startTime;
+		uint64_t				m_endTime;
+		uint32_t				m_numScopes;
+		uint32_t				m_numWide;
+		uint32_t				m_numLanes;
+		ProfilerCapturedScope	m_scopes[RPROF_SCOPES_MAX];
+		uint64_t				m_wide[RPROF_WIDE_SCOPES_MAX][2];
+		uint64_t				m_laneThreads[RPROF_THREADS_MAX];	// thread ID per lane, lanes are reused by later threads
+
+		ProfilerCapturedFrame()
+		{
+			reset(0, 0);
+		}
+
+		inline void reset(uint64_t _startTime, uint64_t _endTime)
+		{
+			m_startTime	= _startTime;
+			m_endTime	= _endTime;
+			m_numScopes	= 0;
+			m_numWide	= 0;
+			m_numLanes	= 0;
+		}
+
+		inline void setLane(uint8_t _lane, uint64_t _threadID)
+		{
+			m_laneThreads[_lane] = _threadID;
+			if (m_numLanes <= _lane)
+				m_numLanes = _lane + 1;
+		}
+
+		inline bool addScope(uint64_t _start, uint64_t _end, uint16_t _callsite, uint8_t _lane, uint8_t _level, bool _open)
+		{
+			if (m_numScopes == RPROF_SCOPES_MAX)
+				return false;
+
+			ProfilerCapturedScope& scope = m_scopes[m_numScopes++];
+			scope.m_callsite	= _callsite;
+			scope.m_lane		= _lane;
+			scope.m_level		= _level;
+			scope.m_flags		= _open ? ProfilerCapturedScope::Open : 0;
+
+			uint64_t offset		= _start - m_startTime;
+			uint64_t duration	= _end - _start;
+			if ((_start >= m_startTime) && (offset <= 0xffffffff) && (duration <= 0xffffffff))
+			{
+				scope.m_start		= (uint32_t)offset;
+				scope.m_duration	= (uint32_t)duration;
+			}
+			else
+			if (m_numWide < RPROF_WIDE_SCOPES_MAX)
+			{
+				scope.m_start		= m_numWide;
+				scope.m_duration	= 0;
+				scope.m_flags		|= ProfilerCapturedScope::Wide;
+				m_wide[m_numWide][0] = _start;
+				m_wide[m_numWide][1] = _end;
+				++m_numWide;
+			}
+			else
+			{
+				// out of wide slots, clamp to frame
+				scope.m_start		= _start < m_startTime ? 0 : (uint32_t)(offset < 0xffffffff ? offset : 0xffffffff);
+				scope.m_duration	= (uint32_t)(duration < 0xffffffff ? duration : 0xffffffff);
+			}
+			return true;
+		}
 
-		Mutex			m_mutex;
-		rprofFreeList_t	m_scopesAllocator;
-		uint32_t		m_scopesOpen;
-		ProfilerScope*	m_scopesCapture[RPROF_SCOPES_MAX];
-		ProfilerScope	m_scopesDisplay[RPROF_SCOPES_MAX];
-		uint32_t		m_displayScopes;
-		uint64_t		m_frameStartTime;
-		uint64_t		m_frameEndTime;
-		bool			m_thresholdCrossed;
-		float			m_timeThreshold;
-		uint32_t		m_levelThreshold;
-		bool			m_pauseProfiling;
-		char			m_namesDataBuffers[BufferUse::Count][RPROF_TEXT_MAX];
-		char*			m_namesData[BufferUse::Count];
-		int				m_namesSize[BufferUse::Count];
-		uint32_t		m_tlsLevel;
+		inline void copyFrom(const ProfilerCapturedFrame& _frame)
+		{
+			m_startTime	= _frame.m_startTime;
+			m_endTime	= _frame.m_endTime;
+			m_numScopes	= _frame.m_numScopes;
+			m_numWide	= _frame.m_numWide;
+			m_numLanes	= _frame.m_numLanes;
+			memcpy(m_scopes, _frame.m_scopes, sizeof(ProfilerCapturedScope) * m_numScopes);
+			memcpy(m_wide, _frame.m_wide, sizeof(m_wide[0]) * m_numWide);
+			memcpy(m_laneThreads, _frame.m_laneThreads, sizeof(m_laneThreads[0]) * m_numLanes);
+		}
+
+		inline void getTimes(const ProfilerCapturedScope& _scope, uint64_t& _start, uint64_t& _end) const
+		{
+			if (_scope.m_flags & ProfilerCapturedScope::Wide)
+			{
+				_start	= m_wide[_scope.m_start][0];
+				_end	= m_wide[_scope.m_start][1];
+			}
+			else
+			{
+				_start	= m_startTime + _scope.m_start;
+				_end	= _start + _scope.m_duration;
+			}
+		}
+	};
+
+	// Single writer capture buffer, one per thread. Owning thread is the only
+	// one writing scope data, frame collector reads it in beginFrame.
+	// Open scope stack and ring head are published through a sequence lock so
+	// that collector can take a consistent snapshot without blocking the owner.
+	// Owner releases the buffer on exit or unregistering, collector then drains
+	// it and hands it to the next thread needing one.
+	struct ProfilerThreadBuffer
+	{
+		// written by owning thread
+		std::atomic<uint32_t>	m_sequence;
+		std::atomic<uint32_t>	m_numOpen;
+		std::atomic<uint32_t>	m_head;
+		std::atomic<uint32_t>	m_released;
+		uint64_t				m_threadID;
+		uint8_t					m_padding0[64];
+
+		// written by collector
+		std::atomic<uint32_t>	m_tail;
+		bool					m_free;
+		uint8_t					m_padding1[64];
+
+		ProfilerOpenScope		m_open[RPROF_THREAD_DEPTH_MAX];
+		ProfilerScopeRecord		m_scopes[RPROF_THREAD_SCOPES_MAX];
+
+		// used by owning thread only, by hash of dynamic name
+		uint32_t				m_dynamicCache[s_dynamicCacheSize];
+
+		ProfilerThreadBuffer(uint64_t _threadID)
+			: m_sequence(0)
+			, m_numOpen(0)
+			, m_head(0)
+			, m_released(0)
+			, m_threadID(_threadID)
+			, m_tail(0)
+			, m_free(false)
+		{
+			memset(m_dynamicCache, 0, sizeof(m_dynamicCache));
+		}
+
+		// only called by collector on a drained and released buffer
+		inline void reuse(uint64_t _threadID)
+		{
+			m_numOpen.store(0, std::memory_order_relaxed);
+			m_head.store(0, std::memory_order_relaxed);
+			m_tail.store(0, std::memory_order_relaxed);
+			m_released.store(0, std::memory_order_relaxed);
+			m_threadID	= _threadID;
+			m_free		= false;
+		}
+
+		inline void writeBegin()
+		{
+			m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		inline void writeEnd()
+		{
+			m_sequence.store(m_sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+	};
+
+	class ProfilerContext
+	{
+		Mutex					m_mutex;
+		ProfilerThreadBuffer*	m_threadBuffers[RPROF_THREADS_MAX];
+		uint32_t				m_numThreadBuffers;
+		uint32_t				m_freeThreadBuffers[RPROF_THREADS_MAX];	// released lanes, reused first
+		uint32_t				m_numFreeThreadBuffers;
+		std::atomic<uint32_t>	m_numDroppedNoThread;
+		std::atomic<uint32_t>	m_numDroppedNoCallsite;
+		std::atomic<uint32_t>	m_numDroppedFull;
+		ProfilerCapturedFrame*	m_frameCapture;
+		ProfilerCapturedFrame*	m_frameDisplay;
+		ProfilerCapturedFrame*	m_history[RPROF_HISTORY_SIZE];
+		uint32_t				m_historyHead;
+		uint32_t				m_historyCount;
+		ProfilerScope			m_scopesExpanded[RPROF_SCOPES_MAX];
+		ProfilerThread			m_threadsExpanded[RPROF_DRAW_THREADS_MAX];
+		ProfilerRecorder*		m_recorder;
+		bool					m_thresholdCrossed;
+		float					m_timeThreshold;
+		uint32_t				m_levelThreshold;
+		bool					m_pauseProfiling;
+		uint32_t				m_tlsBuffer;
+
+		// call site IDs are 1 based indices into m_callsites, 0 is invalid
+		// dynamic name hash table, slots are written once under lock and read without it
+		std::atomic<ProfilerScopeDesc*>	m_callsites[RPROF_CALLSITES_MAX];
+		uint32_t						m_numCallsites;
+		std::atomic<uint32_t>			m_dynamicCallsites[RPROF_CALLSITES_MAX * 2];
 
 		std::unordered_map<uint64_t, std::string>	m_threadNames;
 
@@ -51,19 +253,34 @@ namespace rprof {
 		ProfilerContext();
 		~ProfilerContext();
 
-		void			setThreshold(float _ms, int _levelThreshold);
-		bool			isPaused();
-		bool			wasThresholdCrossed();
-		void			setPaused(bool _paused);
-		void			registerThread(uint64_t _threadID, const char* _name);
-		void			unregisterThread(uint64_t _threadID);
-		void			beginFrame();
-		int				incLevel();
-		void			decLevel();
-		ProfilerScope*	beginScope(const char* _file, int _line, const char* _name);
-		void			endScope(ProfilerScope* _scope);
-		const char*		addString(const char* _name, BufferUse _buffer);
-		void			getFrameData(ProfilerFrame* _data);
+		void					setThreshold(float _ms, int _levelThreshold);
+		bool					isPaused();
+		bool					wasThresholdCrossed();
+		void					setPaused(bool _paused);
+		void					registerThread(uint64_t _threadID, const char* _name);
+		void					unregisterThread(uint64_t _threadID);
+		void					beginFrame();
+		ProfilerOpenScope*		beginScope(const char* _file, int _line, const char* _name);
+		ProfilerOpenScope*		beginScope(ProfilerScopeDesc* _desc);
+		void					endScope(ProfilerOpenScope* _scope);
+		void					getFrameData(ProfilerFrame* _data);
+		uint32_t				getFrameCount();
+		bool					getFrameDataAt(uint32_t _index, ProfilerFrame* _data);
+		void					getFrameData(const ProfilerCapturedFrame* _frame, ProfilerFrame* _data, ProfilerScope* _scopes, ProfilerThread* _threads, std::string* _threadNames);
+		bool					startRecording(const char* _path, int _compression, bool _dictionary);
+		void					stopRecording();
+		void					getRecordingStats(uint32_t* _numWritten, uint32_t* _numDropped);
+		void					getDroppedScopes(uint32_t* _numNoThread, uint32_t* _numNoCallsite, uint32_t* _numFull);
+
+	private:
+		ProfilerOpenScope*		pushScope(ProfilerThreadBuffer* _buffer, uint32_t _callsite);
+		uint32_t				registerCallsite(ProfilerScopeDesc* _desc);
+		uint32_t				addCallsite(ProfilerScopeDesc* _desc);
+		uint32_t				findDynamicCallsite(uint32_t _hash, const char* _file, int _line, const char* _name, uint32_t* _slot);
+		uint32_t				addDynamicCallsite(uint32_t _hash, const char* _file, int _line, const char* _name);
+		ProfilerThreadBuffer*	getThreadBuffer();
+		void					collectThread(ProfilerThreadBuffer* _buffer, uint8_t _lane);
+		void					expandFrame(const ProfilerCapturedFrame* _frame, ProfilerFrame* _data, ProfilerScope* _scopes, ProfilerThread* _threads, std::string* _threadNames);
 	};
 
 } // namespace rprof
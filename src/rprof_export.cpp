@@ -0,0 +1,292 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "../inc/rprof.h"
+#include "rprof_config.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <vector>
+
+/*--------------------------------------------------------------------------
+ * Buffered output, passed to user callback in chunks
+ *------------------------------------------------------------------------*/
+
+struct ExportWriter
+{
+	char					m_buffer[RPROF_EXPORT_BUFFER_SIZE];
+	size_t					m_size;
+	ProfilerWriteCallback	m_write;
+	void*					m_userData;
+	bool					m_failed;
+};
+
+// Largest formatted write, strings are escaped and written separately
+static const size_t s_exportMaxWrite = 256;
+
+static ExportWriter* createExportWriter(ProfilerWriteCallback _write, void* _userData)
+{
+	ExportWriter* writer = new ExportWriter;
+	writer->m_size		= 0;
+	writer->m_write		= _write;
+	writer->m_userData	= _userData;
+	writer->m_failed	= false;
+	return writer;
+}
+
+static void exportFlush(ExportWriter& _writer)
+{
+	if (_writer.m_size && !_writer.m_failed)
+		_writer.m_failed = !_writer.m_write(_writer.m_buffer, _writer.m_size, _writer.m_userData);
+	_writer.m_size = 0;
+}
+
+// Flushes remaining output, returns non zero if all writes succeeded
+static int destroyExportWriter(ExportWriter* _writer)
+{
+	exportFlush(*_writer);
+	int result = _writer->m_failed ? 0 : 1;
+	delete _writer;
+	return result;
+}
+
+static void exportPrintf(ExportWriter& _writer, const char* _format, ...)
+{
+	if (RPROF_EXPORT_BUFFER_SIZE - _writer.m_size < s_exportMaxWrite)
+		exportFlush(_writer);
+
+	va_list args;
+	va_start(args, _format);
+	int len = vsnprintf(&_writer.m_buffer[_writer.m_size], s_exportMaxWrite, _format, args);
+	va_end(args);
+
+	if (len > 0)
+		_writer.m_size += ((size_t)len < s_exportMaxWrite) ? (size_t)len : s_exportMaxWrite - 1;
+}
+
+static void exportString(ExportWriter& _writer, const char* _str)
+{
+	static const char* s_hex = "0123456789abcdef";
+
+	// room for an escaped character and closing quote
+	if (RPROF_EXPORT_BUFFER_SIZE - _writer.m_size < 8)
+		exportFlush(_writer);
+
+	_writer.m_buffer[_writer.m_size++] = '"';
+	for (; _str && *_str; ++_str)
+	{
+		if (RPROF_EXPORT_BUFFER_SIZE - _writer.m_size < 8)
+			exportFlush(_writer);
+
+		char* out = &_writer.m_buffer[_writer.m_size];
+		unsigned char c = (unsigned char)*_str;
+		switch (c)
+		{
+		case '"':	out[0] = '\\'; out[1] = '"';	_writer.m_size += 2;	break;
+		case '\\':	out[0] = '\\'; out[1] = '\\';	_writer.m_size += 2;	break;
+		case '\n':	out[0] = '\\'; out[1] = 'n';	_writer.m_size += 2;	break;
+		case '\r':	out[0] = '\\'; out[1] = 'r';	_writer.m_size += 2;	break;
+		case '\t':	out[0] = '\\'; out[1] = 't';	_writer.m_size += 2;	break;
+		default:
+			if (c < 0x20)
+			{
+				memcpy(out, "\\u00", 4);
+				out[4] = s_hex[c >> 4];
+				out[5] = s_hex[c & 0xf];
+				_writer.m_size += 6;
+			}
+			else
+			{
+				out[0] = (char)c;
+				_writer.m_size++;
+			}
+		};
+	}
+	_writer.m_buffer[_writer.m_size++] = '"';
+}
+
+// Appends literal text, shorter than s_exportMaxWrite
+static void exportText(ExportWriter& _writer, const char* _text, size_t _length)
+{
+	if (RPROF_EXPORT_BUFFER_SIZE - _writer.m_size < s_exportMaxWrite)
+		exportFlush(_writer);
+
+	memcpy(&_writer.m_buffer[_writer.m_size], _text, _length);
+	_writer.m_size += _length;
+}
+
+#define RPROF_EXPORT_TEXT(_writer, _text) exportText(_writer, _text, sizeof(_text) - 1)
+
+static void exportUInt(ExportWriter& _writer, uint64_t _value)
+{
+	char digits[20];
+	uint32_t numDigits = 0;
+	do
+	{
+		digits[numDigits++] = (char)('0' + _value % 10);
+		_value /= 10;
+	} while (_value);
+
+	if (RPROF_EXPORT_BUFFER_SIZE - _writer.m_size < s_exportMaxWrite)
+		exportFlush(_writer);
+
+	char* out = &_writer.m_buffer[_writer.m_size];
+	for (uint32_t i=0; i<numDigits; ++i)
+		out[i] = digits[numDigits - 1 - i];
+	_writer.m_size += numDigits;
+}
+
+/*--------------------------------------------------------------------------
+ * Chrome Trace Event format
+ *------------------------------------------------------------------------*/
+
+// Writes clock value as microseconds with three decimals, events are written
+// with integer formatting as they make up nearly all of the output
+static void exportMicroseconds(ExportWriter& _writer, uint64_t _clock, uint64_t _frequency)
+{
+	uint64_t ns = _frequency ? (uint64_t)((double)_clock * 1000000000.0 / (double)_frequency + 0.5) : 0;
+	exportUInt(_writer, ns / 1000);
+
+	char fraction[4] = { '.', (char)('0' + ns / 100 % 10), (char)('0' + ns / 10 % 10), (char)('0' + ns % 10) };
+	exportText(_writer, fraction, sizeof(fraction));
+}
+
+// Thread names are written once per thread, on first frame containing it
+static void exportChromeThreads(ExportWriter& _writer, const ProfilerFrame& _frame, std::vector<uint64_t>& _threads)
+{
+	for (uint32_t i=0; i<_frame.m_numThreads; ++i)
+	{
+		const ProfilerThread& thread = _frame.m_threads[i];
+
+		bool written = false;
+		for (size_t j=0; j<_threads.size(); ++j)
+			written |= _threads[j] == thread.m_threadID;
+
+		if (written)
+			continue;
+
+		_threads.push_back(thread.m_threadID);
+		exportPrintf(_writer, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%llu,\"args\":{\"name\":", (unsigned long long)thread.m_threadID);
+		exportString(_writer, thread.m_name);
+		exportPrintf(_writer, "}}");
+	}
+}
+
+static void exportChromeFrame(ExportWriter& _writer, const ProfilerFrame& _frame, uint32_t _index, uint64_t _frequency)
+{
+	exportPrintf(_writer, ",\n{\"name\":\"frame %u\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":", _index);
+	exportMicroseconds(_writer, _frame.m_startTime, _frequency);
+	RPROF_EXPORT_TEXT(_writer, "}");
+
+	for (uint32_t i=0; i<_frame.m_numScopes; ++i)
+	{
+		const ProfilerScope& scope = _frame.m_scopes[i];
+
+		RPROF_EXPORT_TEXT(_writer, ",\n{\"name\":");
+		exportString(_writer, scope.m_name);
+		RPROF_EXPORT_TEXT(_writer, ",\"ph\":\"X\",\"pid\":0,\"tid\":");
+		exportUInt(_writer, scope.m_threadID);
+		RPROF_EXPORT_TEXT(_writer, ",\"ts\":");
+		exportMicroseconds(_writer, scope.m_start, _frequency);
+		RPROF_EXPORT_TEXT(_writer, ",\"dur\":");
+		exportMicroseconds(_writer, scope.m_end - scope.m_start, _frequency);
+		RPROF_EXPORT_TEXT(_writer, ",\"args\":{\"file\":");
+		exportString(_writer, scope.m_file);
+		RPROF_EXPORT_TEXT(_writer, ",\"line\":");
+		exportUInt(_writer, scope.m_line);
+		RPROF_EXPORT_TEXT(_writer, "}}");
+	}
+}
+
+/*--------------------------------------------------------------------------
+ * Folded stacks
+ *------------------------------------------------------------------------*/
+
+// Separators of folded stacks format can not be part of scope names
+static void exportFoldedName(ExportWriter& _writer, const char* _name)
+{
+	for (; _name && *_name; ++_name)
+	{
+		if (RPROF_EXPORT_BUFFER_SIZE - _writer.m_size < s_exportMaxWrite)
+			exportFlush(_writer);
+
+		char c = *_name;
+		_writer.m_buffer[_writer.m_size++] = ((c == ';') || (c == '\n') || (c == '\r')) ? '_' : c;
+	}
+}
+
+/*--------------------------------------------------------------------------
+ * API functions
+ *------------------------------------------------------------------------*/
+
+extern "C" {
+
+	int rprofExportChromeTrace(ProfilerCapture* _capture, uint32_t _firstFrame, uint32_t _numFrames, ProfilerWriteCallback _write, void* _userData)
+	{
+		uint32_t numFrames = rprofGetCaptureFrameCount(_capture);
+		uint32_t endFrame = (_firstFrame < numFrames) && (_numFrames < numFrames - _firstFrame) ? _firstFrame + _numFrames : numFrames;
+		uint64_t clockFrequency = rprofGetCaptureClockFrequency(_capture);
+
+		ExportWriter* writer = createExportWriter(_write, _userData);
+
+		ProfilerFrameArena* arena = rprofCreateFrameArena();
+		std::vector<uint64_t> threads;
+
+		// timestamps are kept in clock of the capture, converted to microseconds
+		exportPrintf(*writer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		exportPrintf(*writer, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"rprof\"}}");
+
+		for (uint32_t i=_firstFrame; (i<endFrame) && !writer->m_failed; ++i)
+		{
+			ProfilerFrame frame;
+			if (!rprofLoadCaptureFrameToArena(_capture, i, &frame, arena))
+				continue;
+
+			uint64_t frequency = frame.m_CPUFrequency ? frame.m_CPUFrequency : clockFrequency;
+			exportChromeThreads(*writer, frame, threads);
+			exportChromeFrame(*writer, frame, i, frequency);
+		}
+
+		exportPrintf(*writer, "\n]}\n");
+
+		rprofDestroyFrameArena(arena);
+		return destroyExportWriter(writer);
+	}
+
+	int rprofExportFoldedStacks(ProfilerCallTree* _tree, ProfilerWriteCallback _write, void* _userData)
+	{
+		const ProfilerCallPath* paths;
+		uint64_t frequency;
+		uint32_t numPaths = rprofGetCallPaths(_tree, &paths, &frequency);
+
+		ExportWriter* writer = createExportWriter(_write, _userData);
+
+		std::vector<uint32_t> stack;
+		for (uint32_t i=0; (i<numPaths) && !writer->m_failed; ++i)
+		{
+			uint64_t time = frequency ? (uint64_t)((double)paths[i].m_exclusiveTime * 1000000.0 / (double)frequency + 0.5) : 0;
+			if (!time)
+				continue;
+
+			stack.clear();
+			for (uint32_t path=i; path!=RPROF_CALL_PATH_ROOT; path=paths[path].m_parent)
+				stack.push_back(path);
+
+			for (size_t j=stack.size(); j--;)
+			{
+				exportFoldedName(*writer, paths[stack[j]].m_name);
+				if (j)
+					RPROF_EXPORT_TEXT(*writer, ";");
+			}
+			RPROF_EXPORT_TEXT(*writer, " ");
+			exportUInt(*writer, time);
+			RPROF_EXPORT_TEXT(*writer, "\n");
+		}
+
+		return destroyExportWriter(writer);
+	}
+
+} // extern "C"
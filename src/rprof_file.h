@@ -0,0 +1,164 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef RPROF_FILE_H
+#define RPROF_FILE_H
+
+#include "rprof_platform.h"
+
+/*--------------------------------------------------------------------------
+ * Platforms where capture files are memory mapped, others read whole file
+ *------------------------------------------------------------------------*/
+#define RPROF_FILE_MAPPING_SUPPORTED (	RPROF_PLATFORM_WINDOWS		|| \
+										RPROF_PLATFORM_LINUX		|| \
+										RPROF_PLATFORM_OSX			|| \
+										RPROF_PLATFORM_IOS			|| \
+										RPROF_PLATFORM_ANDROID		|| \
+										RPROF_PLATFORM_EMSCRIPTEN	|| \
+										0)
+
+#if RPROF_FILE_MAPPING_SUPPORTED && !RPROF_PLATFORM_WINDOWS
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace rprof {
+
+	// Read only view of a whole file
+	class MappedFile
+	{
+		const uint8_t*	m_data;
+		uint64_t		m_size;
+#if RPROF_PLATFORM_WINDOWS
+		HANDLE			m_file;
+		HANDLE			m_mapping;
+#elif !RPROF_FILE_MAPPING_SUPPORTED
+		uint8_t*		m_buffer;
+#endif
+
+		MappedFile(const MappedFile& _rhs);
+		MappedFile& operator=(const MappedFile& _rhs);
+
+	public:
+		MappedFile()
+			: m_data(0)
+			, m_size(0)
+#if RPROF_PLATFORM_WINDOWS
+			, m_file(INVALID_HANDLE_VALUE)
+			, m_mapping(0)
+#elif !RPROF_FILE_MAPPING_SUPPORTED
+			, m_buffer(0)
+#endif
+		{
+		}
+
+		~MappedFile()
+		{
+			close();
+		}
+
+		inline const uint8_t*	getData() const { return m_data; }
+		inline uint64_t			getSize() const { return m_size; }
+
+		inline bool open(const char* _path)
+		{
+			close();
+
+#if RPROF_PLATFORM_WINDOWS
+			m_file = CreateFileA(_path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+			if (m_file == INVALID_HANDLE_VALUE)
+				return false;
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size) || !size.QuadPart)
+			{
+				close();
+				return false;
+			}
+
+			m_mapping = CreateFileMappingA(m_file, 0, PAGE_READONLY, 0, 0, 0);
+			if (!m_mapping)
+			{
+				close();
+				return false;
+			}
+
+			m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			m_size = (uint64_t)size.QuadPart;
+#elif RPROF_FILE_MAPPING_SUPPORTED
+			int fd = ::open(_path, O_RDONLY);
+			if (fd < 0)
+				return false;
+
+			struct stat st;
+			if ((fstat(fd, &st) != 0) || (st.st_size <= 0))
+			{
+				::close(fd);
+				return false;
+			}
+
+			// mapping keeps file referenced after descriptor is closed
+			void* data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			::close(fd);
+
+			if (data == MAP_FAILED)
+				return false;
+
+			m_data = (const uint8_t*)data;
+			m_size = (uint64_t)st.st_size;
+#else
+			FILE* file = fopen(_path, "rb");
+			if (!file)
+				return false;
+
+			fileSeek(file, 0, SEEK_END);
+			int64_t size = fileTell(file);
+			fileSeek(file, 0, SEEK_SET);
+
+			if (size > 0)
+			{
+				m_buffer = new uint8_t[(size_t)size];
+				if (fread(m_buffer, 1, (size_t)size, file) == (size_t)size)
+				{
+					m_data = m_buffer;
+					m_size = (uint64_t)size;
+				}
+			}
+			fclose(file);
+#endif
+
+			if (!m_data)
+				close();
+			return m_data != 0;
+		}
+
+		inline void close()
+		{
+#if RPROF_PLATFORM_WINDOWS
+			if (m_data)
+				UnmapViewOfFile(m_data);
+			if (m_mapping)
+				CloseHandle(m_mapping);
+			if (m_file != INVALID_HANDLE_VALUE)
+				CloseHandle(m_file);
+			m_mapping	= 0;
+			m_file		= INVALID_HANDLE_VALUE;
+#elif RPROF_FILE_MAPPING_SUPPORTED
+			if (m_data)
+				munmap((void*)m_data, (size_t)m_size);
+#else
+			delete[] m_buffer;
+			m_buffer = 0;
+#endif
+			m_data = 0;
+			m_size = 0;
+		}
+	};
+
+} // namespace rprof
+
+#endif // RPROF_FILE_H
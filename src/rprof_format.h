@@ -0,0 +1,121 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef RPROF_FORMAT_H
+#define RPROF_FORMAT_H
+
+#include "../inc/rprof.h"
+#include "rprof_config.h"
+
+namespace rprof {
+
+	/*--------------------------------------------------------------------------
+	 * Multi frame capture (.rprofm) layout:
+	 *   header  - MultiFrameHeader
+	 *   frames  - uint32_t compressed size followed by rprofSave data, per frame
+	 *   index   - ProfilerFrameIndex per frame, 8 byte aligned
+	 *   strings - null terminated strings shared by frames
+	 *   MultiFrameStrings
+	 *   trailer - MultiFrameTrailer
+	 * Index and trailer are written when recording is stopped, frames of a file
+	 * without them (interrupted recording) can still be found by scanning.
+	 * Frames reference a string table shared by the whole file, see
+	 * FrameHeader::m_stringBase. Without the trailer the table is rebuilt from
+	 * strings each frame appended to it.
+	 * Legacy files have only the legacy signature followed by frames without
+	 * header.
+	 *------------------------------------------------------------------------*/
+	static const uint32_t s_multiFrameSignatureLegacy	= 0x23232323;
+	static const uint32_t s_multiFrameSignature			= 0x24242424;
+	static const uint32_t s_multiFrameVersion			= 1;
+
+	struct MultiFrameHeader
+	{
+		uint32_t	m_signature;
+		uint32_t	m_version;
+	};
+
+	struct MultiFrameTrailer
+	{
+		uint64_t	m_indexOffset;
+		uint64_t	m_clockFrequency;
+		uint32_t	m_numFrames;
+		uint32_t	m_version;
+		uint32_t	m_reserved;
+		uint32_t	m_signature;
+	};
+
+	struct MultiFrameStrings
+	{
+		uint64_t	m_offset;
+		uint32_t	m_numStrings;
+		uint32_t	m_size;
+	};
+
+	/*--------------------------------------------------------------------------
+	 * Single frame (rprofSave output) layout:
+	 *   header  - FrameHeader, uncompressed, followed by frame summary of
+	 *             m_numTopScopes FrameTopScope records, each followed by
+	 *             null terminated scope name
+	 *   payload - starts at m_headerSize, m_rawSize bytes decompressed
+	 * Payload holds varint encoded scopes grouped by thread. Frames saved with
+	 * a shared string table store only strings from index m_stringBase on,
+	 * lower indices refer to earlier frames.
+	 * Payload is an LZ4 stream of blocks, each block is uint32_t compressed
+	 * size followed by data decompressing to at most RPROF_SAVE_BLOCK_SIZE
+	 * bytes. Frames with m_dictSize set are compressed with first m_dictSize
+	 * bytes of previous frame payload (decompressed) as dictionary, previous
+	 * frame being the one preceding it in a multi frame capture.
+	 * Legacy frames have no header, payload is a single LZ4 block with fixed
+	 * size scope records.
+	 *------------------------------------------------------------------------*/
+	static const uint32_t s_frameSignature	= 0x46525052;	// 'RPRF'
+	static const uint32_t s_frameVersion	= 1;
+
+	struct FrameHeader
+	{
+		uint32_t	m_signature;
+		uint32_t	m_version;
+		uint32_t	m_headerSize;
+		uint32_t	m_rawSize;
+		uint32_t	m_clockSource;
+		uint32_t	m_stringBase;
+		uint64_t	m_startTime;
+		uint64_t	m_endTime;
+		uint64_t	m_frequency;
+		uint32_t	m_numScopes;
+		uint32_t	m_numThreads;
+		uint32_t	m_maxDepth;
+		uint32_t	m_numTopScopes;
+		uint32_t	m_dictSize;
+		uint32_t	m_reserved;
+	};
+
+	struct FrameTopScope
+	{
+		uint64_t	m_exclusiveTime;
+		uint32_t	m_occurences;
+		uint32_t	m_nameSize;
+	};
+
+	struct StringStore;
+
+	// Start of payload of the last frame saved with it, next frame saved with
+	// it is compressed using it as dictionary. Empty for frames that should not
+	// depend on previous ones.
+	struct FrameDictionary
+	{
+		uint8_t		m_data[RPROF_SAVE_DICT_SIZE];
+		uint32_t	m_size;
+	};
+
+	// rprofSave with string table kept across frames (see StringStore) when
+	// _strings is not NULL, and previous frame as dictionary when _dict is
+	// not NULL
+	int saveFrame(ProfilerFrame* _data, void* _buffer, size_t _bufferSize, StringStore* _strings, int _compression, FrameDictionary* _dict);
+
+} // namespace rprof
+
+#endif // RPROF_FORMAT_H
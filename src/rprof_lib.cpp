@@ -5,11 +5,29 @@
 
 #include "../inc/rprof.h"
 #include "rprof_config.h"
+#include "rprof_platform.h"
 #include "rprof_context.h"
+#include "rprof_format.h"
+#include "rprof_file.h"
+#include "rprof_strings.h"
+#include "rprof_thread.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
 
 #include "../3rd/lz4-r191/lz4.h"
+#if RPROF_LZ4_HC
+#include "../3rd/lz4-r191/lz4hc.h"
+#endif
 #if !RPROF_LZ4_NO_DEFINE
 #include "../3rd/lz4-r191/lz4.c"
+#if RPROF_LZ4_HC
+#include "../3rd/lz4-r191/lz4hc.c"
+#endif
 #endif
 
 extern "C" uint64_t rprofGetClockFrequency();
@@ -18,87 +36,1990 @@ extern "C" uint64_t rprofGetClockFrequency();
  * Data load/save functions
  *------------------------------------------------------------------------*/
 
-static inline void memoryCopy(void* _dst, const void* _src, size_t _len)
-{
-	const uint8_t* src = (const uint8_t*)_src;
-	uint8_t* dst = (uint8_t*)_dst;
-	for (size_t i=0; i<_len; ++i)
-		dst[i] = src[i];
+static inline void memoryCopy(void* _dst, const void* _src, size_t _len)
+{
+	const uint8_t* src = (const uint8_t*)_src;
+	uint8_t* dst = (uint8_t*)_dst;
+	for (size_t i=0; i<_len; ++i)
+		dst[i] = src[i];
+}
+
+template <typename T>
+static inline void writeVar(uint8_t*& _buffer, T _var)
+{
+	memoryCopy(_buffer, &_var, sizeof(T));
+	_buffer += sizeof(T);
+}
+
+static inline void writeStr(uint8_t*& _buffer, const char* _str)
+{
+	uint32_t len = (uint32_t)strlen(_str);
+	writeVar(_buffer, len);
+	memoryCopy(_buffer, _str, len);
+	_buffer += len;
+}
+
+template <typename T>
+static inline void readVar(uint8_t*& _buffer, T& _var)
+{
+	memoryCopy(&_var, _buffer, sizeof(T));
+	_buffer += sizeof(T);
+}
+	
+static inline void writeVarint(uint8_t*& _buffer, uint64_t _var)
+{
+	while (_var >= 0x80)
+	{
+		*_buffer++ = (uint8_t)(_var | 0x80);
+		_var >>= 7;
+	}
+	*_buffer++ = (uint8_t)_var;
+}
+
+static inline uint64_t readVarint(uint8_t*& _buffer, const uint8_t* _end)
+{
+	uint64_t var = 0;
+	for (uint32_t shift=0; (_buffer < _end) && (shift < 64); shift += 7)
+	{
+		uint8_t byte = *_buffer++;
+		var |= (uint64_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+			break;
+	}
+	return var;
+}
+
+struct CallsiteKey
+{
+	uint32_t	m_name;
+	uint32_t	m_file;
+	uint32_t	m_line;
+
+	bool operator==(const CallsiteKey& _other) const
+	{
+		return (m_name == _other.m_name) && (m_file == _other.m_file) && (m_line == _other.m_line);
+	}
+};
+
+struct CallsiteKeyHash
+{
+	size_t operator()(const CallsiteKey& _key) const
+	{
+		return (size_t)((_key.m_name * 2654435761u) ^ (_key.m_file * 2246822519u) ^ (_key.m_line * 3266489917u));
+	}
+};
+
+// Reads header of frame saved by rprofSave, fields not present in saved
+// version are zero. Returns false for frames saved without header.
+static bool readFrameHeader(const void* _buffer, size_t _bufferSize, rprof::FrameHeader& _header)
+{
+	using namespace rprof;
+
+	memset(&_header, 0, sizeof(_header));
+	if (_bufferSize < sizeof(_header))
+		return false;
+	memcpy(&_header, _buffer, sizeof(_header));
+
+	if ((_header.m_signature != s_frameSignature) || (_header.m_version != s_frameVersion))
+	{
+		memset(&_header, 0, sizeof(_header));
+		return false;
+	}
+	return true;
+}
+
+// Decompresses payload written by PayloadWriter, returns decompressed size, -1 on failure
+static int decompressBlocks(const uint8_t* _src, size_t _srcSize, uint8_t* _dst, uint32_t _dstSize, const uint8_t* _dict, uint32_t _dictSize)
+{
+	LZ4_streamDecode_t stream;
+	LZ4_setStreamDecode(&stream, (const char*)_dict, (int)_dictSize);
+
+	uint32_t decomp = 0;
+	while (decomp < _dstSize)
+	{
+		uint32_t blockSize;
+		if (_srcSize < sizeof(blockSize))
+			return -1;
+		memcpy(&blockSize, _src, sizeof(blockSize));
+		_src		+= sizeof(blockSize);
+		_srcSize	-= sizeof(blockSize);
+
+		if (blockSize > _srcSize)
+			return -1;
+
+		int size = LZ4_decompress_safe_continue(&stream, (const char*)_src, (char*)_dst + decomp, (int)blockSize, (int)(_dstSize - decomp));
+		if (size <= 0)
+			return -1;
+
+		decomp		+= (uint32_t)size;
+		_src		+= blockSize;
+		_srcSize	-= blockSize;
+	}
+	return (int)decomp;
+}
+
+// Decompresses frame saved by rprofSave, frames without header need the
+// decompressed size to be found by retrying with larger buffers. Frames
+// compressed with a dictionary (see FrameHeader::m_dictSize) need payload
+// of previous frame as _dict.
+// Returns decompressed size, -1 on failure.
+static int decompressFrame(const void* _buffer, size_t _bufferSize, std::vector<uint8_t>& _raw, rprof::FrameHeader& _header, const uint8_t* _dict = 0, uint32_t _dictSize = 0)
+{
+	using namespace rprof;
+
+	const uint8_t* data = (const uint8_t*)_buffer;
+
+	if (readFrameHeader(data, _bufferSize, _header))
+	{
+		if ((_header.m_headerSize < sizeof(FrameHeader)) || (_header.m_headerSize > _bufferSize) ||
+			(_header.m_rawSize > RPROF_LZ4_BUFFER_MAX_SIZE) || (_header.m_dictSize > _dictSize))
+			return -1;
+
+		_raw.resize(_header.m_rawSize ? _header.m_rawSize : 1);
+		int decomp = decompressBlocks(data + _header.m_headerSize, _bufferSize - _header.m_headerSize, &_raw[0], _header.m_rawSize, _dict, _header.m_dictSize);
+		return decomp == (int)_header.m_rawSize ? decomp : -1;
+	}
+
+	memset(&_header, 0, sizeof(_header));
+	_header.m_clockSource = RPROF_CLOCK_UNKNOWN;
+
+	int decomp = -1;
+	size_t bufferSize = _bufferSize;
+	do
+	{
+		bufferSize *= 2;
+		_raw.resize(bufferSize);
+		decomp = LZ4_decompress_safe((const char*)data, (char*)&_raw[0], (int)_bufferSize, (int)bufferSize);
+
+	} while ((decomp < 0) && (bufferSize <= RPROF_LZ4_BUFFER_MAX_SIZE));
+
+	return decomp;
+}
+
+struct ScopeStartOrder
+{
+	const ProfilerScope* m_scopes;
+
+	bool operator()(uint32_t _a, uint32_t _b) const
+	{
+		const ProfilerScope& a = m_scopes[_a];
+		const ProfilerScope& b = m_scopes[_b];
+		if (a.m_threadID != b.m_threadID)	return a.m_threadID < b.m_threadID;
+		if (a.m_start != b.m_start)			return a.m_start < b.m_start;
+		return a.m_level < b.m_level;
+	}
+};
+
+static uint32_t getMaxLevel(const ProfilerScope* _scopes, uint32_t _numScopes)
+{
+	uint32_t maxLevel = 0;
+	for (uint32_t i=0; i<_numScopes; ++i)
+		if (maxLevel < _scopes[i].m_level)
+			maxLevel = _scopes[i].m_level;
+	return maxLevel;
+}
+
+// Sorts scope indices in (thread, start, level) order
+static void sortScopes(const ProfilerScope* _scopes, uint32_t _numScopes, uint32_t* _order)
+{
+	for (uint32_t i=0; i<_numScopes; ++i)
+		_order[i] = i;
+
+	ScopeStartOrder startOrder = { _scopes };
+	std::sort(_order, _order + _numScopes, startOrder);
+}
+
+// Exclusive time is scope time minus time of its direct children. Scopes are
+// visited in sortScopes order, parent of a scope is the last visited scope one
+// level up on the same thread, if it contains the scope.
+// _lastAtLevel needs space for (maximum scope level + 1) entries.
+static void calculateExclusiveTimes(const ProfilerScope* _scopes, uint32_t _numScopes, const uint32_t* _order, uint64_t* _exclusiveTimes, uint32_t* _lastAtLevel, uint32_t _maxLevel)
+{
+	const uint32_t invalid = 0xffffffff;
+	for (uint32_t i=0; i<=_maxLevel; ++i)
+		_lastAtLevel[i] = invalid;
+
+	for (uint32_t i=0; i<_numScopes; ++i)
+		_exclusiveTimes[i] = _scopes[i].m_end - _scopes[i].m_start;
+
+	for (uint32_t i=0; i<_numScopes; ++i)
+	{
+		const ProfilerScope& scope = _scopes[_order[i]];
+		_lastAtLevel[scope.m_level] = _order[i];
+
+		if (!scope.m_level)
+			continue;
+
+		uint32_t parentIndex = _lastAtLevel[scope.m_level - 1];
+		if (parentIndex == invalid)
+			continue;
+
+		// scopes clamped to frame start can start together with their siblings
+		// and be taken for children of them, exclusive time must not wrap
+		const ProfilerScope& parent = _scopes[parentIndex];
+		if ((parent.m_threadID == scope.m_threadID) && (parent.m_start <= scope.m_start) && (parent.m_end >= scope.m_end))
+			_exclusiveTimes[parentIndex] -= std::min(scope.m_end - scope.m_start, _exclusiveTimes[parentIndex]);
+	}
+}
+
+// Reads frame summary from header, names point into the buffer
+static bool readFrameSummary(const void* _buffer, size_t _bufferSize, ProfilerFrameSummary* _summary)
+{
+	using namespace rprof;
+
+	const uint8_t* data = (const uint8_t*)_buffer;
+
+	FrameHeader header;
+	if (!readFrameHeader(data, _bufferSize, header) ||
+		(header.m_headerSize < sizeof(FrameHeader)) || (header.m_headerSize > _bufferSize))
+		return false;
+
+	_summary->m_startTime		= header.m_startTime;
+	_summary->m_endTime			= header.m_endTime;
+	_summary->m_CPUFrequency	= header.m_frequency;
+	_summary->m_numScopes		= header.m_numScopes;
+	_summary->m_numThreads		= header.m_numThreads;
+	_summary->m_maxDepth		= header.m_maxDepth;
+	_summary->m_numTopScopes	= 0;
+
+	size_t offset = sizeof(FrameHeader);
+	for (uint32_t i=0; i<header.m_numTopScopes; ++i)
+	{
+		FrameTopScope topScope;
+		if (offset + sizeof(topScope) > header.m_headerSize)
+			return false;
+		memcpy(&topScope, data + offset, sizeof(topScope));
+		offset += sizeof(topScope);
+
+		const char* name = (const char*)data + offset;
+		if (!topScope.m_nameSize || (offset + topScope.m_nameSize > header.m_headerSize) || name[topScope.m_nameSize - 1])
+			return false;
+		offset += topScope.m_nameSize;
+
+		if (i < RPROF_SUMMARY_SCOPES_MAX)
+		{
+			ProfilerSummaryScope& scope = _summary->m_topScopes[_summary->m_numTopScopes++];
+			scope.m_name			= name;
+			scope.m_exclusiveTime	= topScope.m_exclusiveTime;
+			scope.m_occurences		= topScope.m_occurences;
+		}
+	}
+	return true;
+}
+
+struct StringRef
+{
+	const char*	m_str;
+	uint32_t	m_length;
+};
+
+// Frame loading scratch memory and, for rprofLoadToArena, loaded frame data.
+// Vectors keep their capacity so loading similar frames does not allocate.
+struct ProfilerFrameArena
+{
+	ProfilerFrameArena()
+		: m_captureID(0)
+		, m_captureFrame(0)
+		, m_captureRawSize(0)
+	{
+	}
+
+	std::vector<uint64_t>		m_memory;
+	std::vector<uint8_t>		m_raw;
+	std::vector<ProfilerScope>	m_scopes;
+	std::vector<ProfilerThread>	m_threads;
+	std::vector<StringRef>		m_strings;
+	std::vector<CallsiteKey>	m_callsites;
+	std::vector<uint32_t>		m_stringOffsets;
+	std::vector<uint32_t>		m_nameIndices;
+	std::vector<uint32_t>		m_statsIndices;
+	std::vector<uint32_t>		m_order;
+	std::vector<uint32_t>		m_lastAtLevel;
+	std::vector<uint64_t>		m_exclusiveTimes;
+
+	// payload of last decompressed capture frame, see decodeCaptureFrame
+	std::vector<uint8_t>		m_captureRaw;
+	std::vector<uint8_t>		m_captureRawScratch;
+	uint64_t					m_captureID;
+	uint32_t					m_captureFrame;
+	uint32_t					m_captureRawSize;
+};
+
+// Strings are not null terminated in frame data, returned string points into the buffer
+static inline StringRef readStringRef(uint8_t*& _buffer, const uint8_t* _end)
+{
+	StringRef str = { "", 0 };
+	if (_end - _buffer < (ptrdiff_t)sizeof(uint32_t))
+	{
+		_buffer = (uint8_t*)_end;
+		return str;
+	}
+
+	uint32_t len;
+	readVar(_buffer, len);
+	if (len > (uint32_t)(_end - _buffer))
+		len = (uint32_t)(_end - _buffer);
+
+	str.m_str		= (const char*)_buffer;
+	str.m_length	= len;
+	_buffer += len;
+	return str;
+}
+
+// Limits element count read from frame data to what the remaining data can hold
+static inline uint32_t clampCount(uint64_t _count, const uint8_t* _buffer, const uint8_t* _end, uint32_t _minElementSize)
+{
+	uint64_t maxCount = (uint64_t)(_end - _buffer) / _minElementSize;
+	return (uint32_t)(_count < maxCount ? _count : maxCount);
+}
+
+// Frame data saved without header, fixed size scope records
+static void readScopesLegacy(ProfilerFrameArena& _arena, uint8_t*& _buffer, const uint8_t* _end)
+{
+	const uint32_t scopeSize	= 3 * sizeof(uint64_t) + 4 * sizeof(uint32_t);
+	const uint32_t threadSize	= sizeof(uint64_t) + sizeof(uint32_t);
+
+	uint32_t strIdx;
+	uint32_t count = 0;
+
+	// read scopes
+	if (_end - _buffer >= (ptrdiff_t)sizeof(count))
+		readVar(_buffer, count);
+	_arena.m_scopes.resize(clampCount(count, _buffer, _end, scopeSize));
+
+	for (uint32_t i=0; i<_arena.m_scopes.size(); ++i)
+	{
+		ProfilerScope& scope = _arena.m_scopes[i];
+		readVar(_buffer, scope.m_start);
+		readVar(_buffer, scope.m_end);
+		readVar(_buffer, scope.m_threadID);
+		readVar(_buffer, strIdx);
+		scope.m_name = (const char*)(uintptr_t)strIdx;
+		readVar(_buffer, strIdx);
+		scope.m_file = (const char*)(uintptr_t)strIdx;
+		readVar(_buffer, scope.m_line);
+		readVar(_buffer, scope.m_level);
+	}
+
+	// read thread info
+	count = 0;
+	if (_end - _buffer >= (ptrdiff_t)sizeof(count))
+		readVar(_buffer, count);
+	_arena.m_threads.resize(clampCount(count, _buffer, _end, threadSize));
+
+	for (uint32_t i=0; i<_arena.m_threads.size(); ++i)
+	{
+		ProfilerThread& t = _arena.m_threads[i];
+		readVar(_buffer, t.m_threadID);
+		readVar(_buffer, strIdx);
+		t.m_name = (const char*)(uintptr_t)strIdx;
+	}
+
+	// read string data
+	count = 0;
+	if (_end - _buffer >= (ptrdiff_t)sizeof(count))
+		readVar(_buffer, count);
+	_arena.m_strings.resize(clampCount(count, _buffer, _end, sizeof(uint32_t)));
+
+	for (uint32_t i=0; i<_arena.m_strings.size(); ++i)
+		_arena.m_strings[i] = readStringRef(_buffer, _end);
+}
+
+// Frame data with varint encoded scopes grouped by thread, see saveFrame
+static void readScopes(ProfilerFrameArena& _arena, uint8_t*& _buffer, const uint8_t* _end, uint64_t _startTime)
+{
+	// read string data
+	_arena.m_strings.resize(clampCount(readVarint(_buffer, _end), _buffer, _end, sizeof(uint32_t)));
+	for (uint32_t i=0; i<_arena.m_strings.size(); ++i)
+		_arena.m_strings[i] = readStringRef(_buffer, _end);
+
+	// read thread info
+	_arena.m_threads.resize(clampCount(readVarint(_buffer, _end), _buffer, _end, 2));
+	for (uint32_t i=0; i<_arena.m_threads.size(); ++i)
+	{
+		ProfilerThread& t = _arena.m_threads[i];
+		t.m_threadID	= readVarint(_buffer, _end);
+		t.m_name		= (const char*)(uintptr_t)readVarint(_buffer, _end);
+	}
+
+	// read call sites
+	std::vector<CallsiteKey>& callsites = _arena.m_callsites;
+	callsites.resize(clampCount(readVarint(_buffer, _end), _buffer, _end, 3));
+	uint32_t numCallsites = (uint32_t)callsites.size();
+	for (uint32_t i=0; i<numCallsites; ++i)
+	{
+		callsites[i].m_name = (uint32_t)readVarint(_buffer, _end);
+		callsites[i].m_file = (uint32_t)readVarint(_buffer, _end);
+		callsites[i].m_line = (uint32_t)readVarint(_buffer, _end);
+	}
+
+	// read scopes, lane by lane
+	uint32_t numScopes	= clampCount(readVarint(_buffer, _end), _buffer, _end, 4);
+	uint32_t numLanes	= (uint32_t)readVarint(_buffer, _end);
+	_arena.m_scopes.resize(numScopes);
+
+	const CallsiteKey invalidCallsite = { 0xffffffff, 0xffffffff, 0 };
+
+	uint32_t scopeIndex = 0;
+	for (uint32_t lane=0; (lane<numLanes) && (scopeIndex<numScopes); ++lane)
+	{
+		uint64_t threadID		= readVarint(_buffer, _end);
+		uint32_t numLaneScopes	= (uint32_t)readVarint(_buffer, _end);
+		if (numLaneScopes > numScopes - scopeIndex)
+			numLaneScopes = numScopes - scopeIndex;
+
+		uint64_t start = 0;
+		for (uint32_t i=0; i<numLaneScopes; ++i)
+		{
+			ProfilerScope& scope = _arena.m_scopes[scopeIndex++];
+			start			+= readVarint(_buffer, _end);
+			scope.m_start	= start;
+			scope.m_end		= start + readVarint(_buffer, _end);
+			scope.m_threadID= threadID;
+
+			uint32_t callsite = (uint32_t)readVarint(_buffer, _end);
+			const CallsiteKey& key = callsite < numCallsites ? callsites[callsite] : invalidCallsite;
+			scope.m_name	= (const char*)(uintptr_t)key.m_name;
+			scope.m_file	= (const char*)(uintptr_t)key.m_file;
+			scope.m_line	= key.m_line;
+			scope.m_level	= (uint32_t)readVarint(_buffer, _end);
+		}
+	}
+
+	// truncated data
+	for (; scopeIndex<numScopes; ++scopeIndex)
+	{
+		ProfilerScope& scope = _arena.m_scopes[scopeIndex];
+		scope.m_start		= _startTime;
+		scope.m_end			= _startTime;
+		scope.m_threadID	= 0;
+		scope.m_name		= (const char*)(uintptr_t)invalidCallsite.m_name;
+		scope.m_file		= (const char*)(uintptr_t)invalidCallsite.m_file;
+		scope.m_line		= 0;
+		scope.m_level		= 0;
+	}
+}
+
+/*--------------------------------------------------------------------------
+ * Frame saving
+ *------------------------------------------------------------------------*/
+
+// RPROF_COMPRESSION_HIGH is default level without LZ4 HC
+static inline int getCompression(int _compression)
+{
+#if RPROF_LZ4_HC
+	if (_compression == RPROF_COMPRESSION_HIGH)
+		return RPROF_COMPRESSION_HIGH;
+#endif
+	return _compression == RPROF_COMPRESSION_FAST ? RPROF_COMPRESSION_FAST : RPROF_COMPRESSION_DEFAULT;
+}
+
+static inline size_t getCompressionStreamSize(int _compression)
+{
+#if RPROF_LZ4_HC
+	if (_compression == RPROF_COMPRESSION_HIGH)
+		return sizeof(LZ4_streamHC_t);
+#endif
+	(void)_compression;
+	return sizeof(LZ4_stream_t);
+}
+
+// Initializes LZ4 stream in _memory, dictionary must stay in place while stream is used
+static void* initCompressionStream(void* _memory, int _compression, const uint8_t* _dict, uint32_t _dictSize)
+{
+#if RPROF_LZ4_HC
+	if (_compression == RPROF_COMPRESSION_HIGH)
+	{
+		LZ4_streamHC_t* stream = LZ4_initStreamHC(_memory, sizeof(LZ4_streamHC_t));
+		if (_dictSize)
+			LZ4_loadDictHC(stream, (const char*)_dict, (int)_dictSize);
+		return stream;
+	}
+#endif
+	(void)_compression;
+	LZ4_stream_t* stream = LZ4_initStream(_memory, sizeof(LZ4_stream_t));
+	if (_dictSize)
+		LZ4_loadDict(stream, (const char*)_dict, (int)_dictSize);
+	return stream;
+}
+
+static inline int compressBlock(void* _stream, int _compression, const char* _src, char* _dst, int _srcSize, int _dstSize)
+{
+#if RPROF_LZ4_HC
+	if (_compression == RPROF_COMPRESSION_HIGH)
+		return LZ4_compress_HC_continue((LZ4_streamHC_t*)_stream, _src, _dst, _srcSize, _dstSize);
+#endif
+	int acceleration = _compression == RPROF_COMPRESSION_FAST ? RPROF_LZ4_FAST_ACCELERATION : 1;
+	return LZ4_compress_fast_continue((LZ4_stream_t*)_stream, _src, _dst, _srcSize, _dstSize, acceleration);
+}
+
+// Streams frame payload through LZ4. Payload is written to a staging block
+// that is compressed when full, two staging blocks are used in turn so the
+// previous block stays in place as dictionary for the next one. Each block is
+// stored as uint32_t compressed size followed by compressed data.
+// Start of the payload is copied to _dictOut, if not NULL, to be used as
+// dictionary for the next frame.
+struct PayloadWriter
+{
+	void*			m_stream;
+	int				m_compression;
+	char*			m_blocks;
+	uint32_t		m_block;
+	uint32_t		m_used;
+	uint8_t*		m_out;
+	uint8_t*		m_outEnd;
+	uint8_t*		m_dictOut;
+	uint32_t		m_rawSize;
+	bool			m_failed;
+
+	PayloadWriter(void* _stream, int _compression, char* _blocks, uint8_t* _out, uint8_t* _outEnd, uint8_t* _dictOut)
+		: m_stream(_stream)
+		, m_compression(_compression)
+		, m_blocks(_blocks)
+		, m_block(0)
+		, m_used(0)
+		, m_out(_out)
+		, m_outEnd(_outEnd)
+		, m_dictOut(_dictOut)
+		, m_rawSize(0)
+		, m_failed(false)
+	{
+	}
+
+	inline uint8_t* getBlock()
+	{
+		return (uint8_t*)m_blocks + m_block * RPROF_SAVE_BLOCK_SIZE;
+	}
+
+	void flush()
+	{
+		if (!m_used)
+			return;
+
+		int size = 0;
+		if (!m_failed && (m_outEnd - m_out > (ptrdiff_t)sizeof(uint32_t)))
+			size = compressBlock(m_stream, m_compression, (const char*)getBlock(), (char*)m_out + sizeof(uint32_t), (int)m_used, (int)(m_outEnd - m_out - sizeof(uint32_t)));
+
+		if (m_dictOut && (m_rawSize < RPROF_SAVE_DICT_SIZE))
+		{
+			uint32_t dictSize = RPROF_SAVE_DICT_SIZE - m_rawSize;
+			memcpy(m_dictOut + m_rawSize, getBlock(), m_used < dictSize ? m_used : dictSize);
+		}
+
+		if (size > 0)
+		{
+			uint32_t blockSize = (uint32_t)size;
+			writeVar(m_out, blockSize);
+			m_out += blockSize;
+		}
+		else
+			m_failed = true;
+
+		m_rawSize	+= m_used;
+		m_block		^= 1;
+		m_used		 = 0;
+	}
+
+	// Returns space for _size bytes in staging block, at most RPROF_SAVE_BLOCK_SIZE
+	inline uint8_t* reserve(uint32_t _size)
+	{
+		if (m_used + _size > RPROF_SAVE_BLOCK_SIZE)
+			flush();
+		return getBlock() + m_used;
+	}
+
+	inline void commit(const uint8_t* _end)
+	{
+		m_used = (uint32_t)(_end - getBlock());
+	}
+
+	template <typename T>
+	inline void write(T _var)
+	{
+		uint8_t* buffer = reserve(sizeof(T));
+		writeVar(buffer, _var);
+		commit(buffer);
+	}
+
+	inline void writeVarint(uint64_t _var)
+	{
+		uint8_t* buffer = reserve(10);
+		::writeVarint(buffer, _var);
+		commit(buffer);
+	}
+
+	// see writeStr
+	void writeStr(const char* _str)
+	{
+		uint32_t len = (uint32_t)strlen(_str);
+		write(len);
+
+		while (len)
+		{
+			if (m_used == RPROF_SAVE_BLOCK_SIZE)
+				flush();
+
+			uint32_t size = RPROF_SAVE_BLOCK_SIZE - m_used;
+			if (size > len)
+				size = len;
+
+			memcpy(getBlock() + m_used, _str, size);
+			m_used	+= size;
+			_str	+= size;
+			len		-= size;
+		}
+	}
+};
+
+// Working memory of saveFrame, see layoutSaveScratch
+struct SaveScratch
+{
+	uint64_t*		m_stream;			// LZ4_stream_t or LZ4_streamHC_t
+	char*			m_dict;				// dictionary, followed by staging blocks
+	char*			m_blocks;			// two staging blocks
+	uint64_t*		m_exclusiveTimes;	// per scope
+	uint32_t*		m_order;			// per scope
+	uint32_t*		m_scopeNames;		// per scope
+	uint32_t*		m_scopeFiles;		// per scope
+	uint32_t*		m_scopeCallsites;	// per scope
+	uint32_t*		m_threadNames;		// per thread
+	uint32_t*		m_lastAtLevel;		// maximum scope level + 1
+	CallsiteKey*	m_callsites;		// up to one per scope
+	uint64_t*		m_callsiteTimes;
+	uint32_t*		m_callsiteCounts;
+	uint32_t*		m_callsiteOrder;
+	uint32_t*		m_callsiteHash;
+	const char**	m_strings;			// up to two per scope and one per thread, without StringStore
+	uint32_t*		m_stringHash;
+	const char**	m_stringCache;		// last string seen per slot, by address
+	uint32_t*		m_stringCacheIndices;
+	uint32_t		m_callsiteHashSize;
+	uint32_t		m_stringHashSize;
+};
+
+struct SaveBounds
+{
+	size_t			m_outputSize;
+	size_t			m_scratchSize;
+	uint32_t		m_maxLevel;
+};
+
+// Open addressing tables, at most half full
+static inline uint32_t getHashTableSize(uint32_t _numEntries)
+{
+	uint32_t size = 16;
+	while (size < _numEntries * 2)
+		size *= 2;
+	return size;
+}
+
+template <typename T>
+static inline void layoutScratch(T*& _ptr, uint8_t* _memory, size_t& _offset, size_t _count)
+{
+	_ptr	 = _memory ? (T*)(_memory + _offset) : 0;
+	_offset	+= (_count * sizeof(T) + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+
+// Returns working memory size, assigns scratch pointers if _memory is not NULL
+static size_t layoutSaveScratch(const ProfilerFrame* _data, uint32_t _maxLevel, bool _localStrings, int _compression, bool _dict, uint8_t* _memory, SaveScratch& _scratch)
+{
+	uint32_t numScopes		= _data->m_numScopes;
+	uint32_t numThreads		= _data->m_numThreads;
+	uint32_t maxStrings		= _localStrings ? numScopes * 2 + numThreads : 0;
+
+	_scratch.m_callsiteHashSize	= getHashTableSize(numScopes);
+	_scratch.m_stringHashSize	= _localStrings ? getHashTableSize(maxStrings) : 0;
+
+	size_t offset = 0;
+	layoutScratch(_scratch.m_stream,			_memory, offset, (getCompressionStreamSize(_compression) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	layoutScratch(_scratch.m_dict,				_memory, offset, _dict ? RPROF_SAVE_DICT_SIZE : 0);
+	layoutScratch(_scratch.m_blocks,			_memory, offset, RPROF_SAVE_BLOCK_SIZE * 2);
+	layoutScratch(_scratch.m_exclusiveTimes,	_memory, offset, numScopes);
+	layoutScratch(_scratch.m_order,				_memory, offset, numScopes);
+	layoutScratch(_scratch.m_scopeNames,		_memory, offset, numScopes);
+	layoutScratch(_scratch.m_scopeFiles,		_memory, offset, numScopes);
+	layoutScratch(_scratch.m_scopeCallsites,	_memory, offset, numScopes);
+	layoutScratch(_scratch.m_threadNames,		_memory, offset, numThreads);
+	layoutScratch(_scratch.m_lastAtLevel,		_memory, offset, _maxLevel + 1);
+	layoutScratch(_scratch.m_callsites,			_memory, offset, numScopes);
+	layoutScratch(_scratch.m_callsiteTimes,		_memory, offset, numScopes);
+	layoutScratch(_scratch.m_callsiteCounts,	_memory, offset, numScopes);
+	layoutScratch(_scratch.m_callsiteOrder,		_memory, offset, numScopes);
+	layoutScratch(_scratch.m_callsiteHash,		_memory, offset, _scratch.m_callsiteHashSize);
+	layoutScratch(_scratch.m_strings,			_memory, offset, maxStrings);
+	layoutScratch(_scratch.m_stringHash,		_memory, offset, _scratch.m_stringHashSize);
+	layoutScratch(_scratch.m_stringCache,		_memory, offset, _scratch.m_stringHashSize);
+	layoutScratch(_scratch.m_stringCacheIndices,_memory, offset, _scratch.m_stringHashSize);
+	return offset;
+}
+
+// Upper bound of saveFrame output and its working memory size
+static void getSaveBounds(const ProfilerFrame* _data, bool _localStrings, int _compression, bool _dict, SaveBounds& _bounds)
+{
+	uint32_t numScopes	= _data->m_numScopes;
+	uint32_t numThreads	= _data->m_numThreads;
+
+	uint64_t stringsSize	= 0;
+	uint32_t maxNameSize	= 0;
+	_bounds.m_maxLevel		= getMaxLevel(_data->m_scopes, numScopes);
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		const ProfilerScope& scope = _data->m_scopes[i];
+		uint32_t nameSize = (uint32_t)strlen(scope.m_name);
+		stringsSize += 2 * sizeof(uint32_t) + nameSize + strlen(scope.m_file);
+		if (maxNameSize < nameSize)
+			maxNameSize = nameSize;
+	}
+	for (uint32_t i=0; i<numThreads; ++i)
+		stringsSize += sizeof(uint32_t) + strlen(_data->m_threads[i].m_name);
+
+	// see saveFrame for layout, varints take up to 10 bytes, 5 for 32 bit values
+	uint64_t rawSize =	3 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t) +
+						10 + stringsSize +
+						10 + (uint64_t)numThreads * (10 + 5) +
+						10 + (uint64_t)numScopes * (5 + 5 + 5) +
+						10 + 10 + (uint64_t)numScopes * (10 + 5) +
+						(uint64_t)numScopes * (10 + 10 + 5 + 5);
+
+	uint64_t numBlocks = rawSize / RPROF_SAVE_BLOCK_SIZE + 1;
+
+	_bounds.m_outputSize =	sizeof(rprof::FrameHeader) +
+							RPROF_SUMMARY_SCOPES_MAX * (sizeof(rprof::FrameTopScope) + maxNameSize + 1) +
+							(size_t)numBlocks * (sizeof(uint32_t) + LZ4_COMPRESSBOUND(RPROF_SAVE_BLOCK_SIZE));
+
+	SaveScratch scratch;
+	_bounds.m_scratchSize = layoutSaveScratch(_data, _bounds.m_maxLevel, _localStrings, _compression, _dict, 0, scratch);
+}
+
+static inline uint32_t hashString(const char* _str)
+{
+	uint32_t hash = 2166136261u;
+	while (*_str)
+		hash = (hash ^ (uint8_t)*_str++) * 16777619u;
+	return hash;
+}
+
+static uint32_t addScratchString(SaveScratch& _scratch, uint32_t& _numStrings, const char* _str)
+{
+	uint32_t mask = _scratch.m_stringHashSize - 1;
+
+	// scopes of a call site share name and file pointers, content is hashed once per pointer
+	uint32_t cacheSlot = (uint32_t)(((uintptr_t)_str >> 3) * 2654435761u) & mask;
+	if (_scratch.m_stringCache[cacheSlot] == _str)
+		return _scratch.m_stringCacheIndices[cacheSlot];
+
+	uint32_t index;
+	for (uint32_t slot = hashString(_str) & mask;; slot = (slot + 1) & mask)
+	{
+		uint32_t entry = _scratch.m_stringHash[slot];
+		if (!entry)
+		{
+			_scratch.m_strings[_numStrings]	= _str;
+			_scratch.m_stringHash[slot]		= ++_numStrings;
+			index = _numStrings - 1;
+			break;
+		}
+
+		const char* str = _scratch.m_strings[entry - 1];
+		if ((str == _str) || !strcmp(str, _str))
+		{
+			index = entry - 1;
+			break;
+		}
+	}
+
+	_scratch.m_stringCache[cacheSlot]			= _str;
+	_scratch.m_stringCacheIndices[cacheSlot]	= index;
+	return index;
+}
+
+static uint32_t addScratchCallsite(SaveScratch& _scratch, uint32_t& _numCallsites, const CallsiteKey& _key)
+{
+	uint32_t mask = _scratch.m_callsiteHashSize - 1;
+	for (uint32_t slot = (uint32_t)CallsiteKeyHash()(_key) & mask;; slot = (slot + 1) & mask)
+	{
+		uint32_t entry = _scratch.m_callsiteHash[slot];
+		if (!entry)
+		{
+			_scratch.m_callsites[_numCallsites]	= _key;
+			_scratch.m_callsiteHash[slot]		= ++_numCallsites;
+			return _numCallsites - 1;
+		}
+
+		if (_scratch.m_callsites[entry - 1] == _key)
+			return entry - 1;
+	}
+}
+
+struct CallsiteNameOrder
+{
+	const CallsiteKey* m_callsites;
+
+	bool operator()(uint32_t _a, uint32_t _b) const
+	{
+		return m_callsites[_a].m_name < m_callsites[_b].m_name;
+	}
+};
+
+static inline const char* getSaveString(const rprof::StringStore* _strStore, const SaveScratch& _scratch, uint32_t _index)
+{
+	return _strStore ? _strStore->m_strings[_index].c_str() : _scratch.m_strings[_index];
+}
+
+struct SummaryScope
+{
+	uint32_t	m_name;
+	uint64_t	m_exclusiveTime;
+	uint32_t	m_occurences;
+};
+
+int rprof::saveFrame(ProfilerFrame* _data, void* _buffer, size_t _bufferSize, StringStore* _strStore, int _compression, FrameDictionary* _dict)
+{
+	uint32_t numScopes	= _data->m_numScopes;
+	uint32_t numThreads	= _data->m_numThreads;
+	int compression		= getCompression(_compression);
+
+	SaveBounds bounds;
+	getSaveBounds(_data, !_strStore, compression, _dict != 0, bounds);
+
+	// working memory is at the end of the buffer if it fits, allocated otherwise
+	uint8_t* output		= (uint8_t*)_buffer;
+	size_t outputSize	= _bufferSize;
+	uint8_t* scratchMemory;
+	std::vector<uint64_t> scratchStorage;
+
+	if (_bufferSize >= bounds.m_outputSize + bounds.m_scratchSize + sizeof(uint64_t))
+	{
+		uintptr_t end	= ((uintptr_t)output + _bufferSize) & ~(uintptr_t)(sizeof(uint64_t) - 1);
+		scratchMemory	= (uint8_t*)(end - bounds.m_scratchSize);
+		outputSize		= (size_t)(scratchMemory - output);
+	}
+	else
+	{
+		scratchStorage.resize(bounds.m_scratchSize / sizeof(uint64_t));
+		scratchMemory = (uint8_t*)&scratchStorage[0];
+	}
+
+	SaveScratch scratch;
+	layoutSaveScratch(_data, bounds.m_maxLevel, !_strStore, compression, _dict != 0, scratchMemory, scratch);
+
+	// strings already in the store were saved with previous frames
+	uint32_t stringBase = _strStore ? _strStore->getNumStrings() : 0;
+	uint32_t numStrings = 0;
+
+	if (_strStore)
+	{
+		for (uint32_t i=0; i<numScopes; ++i)
+		{
+			ProfilerScope& scope = _data->m_scopes[i];
+			scratch.m_scopeNames[i] = _strStore->addStaticString(scope.m_name);
+			scratch.m_scopeFiles[i] = _strStore->addStaticString(scope.m_file);
+		}
+		for (uint32_t i=0; i<numThreads; ++i)
+			scratch.m_threadNames[i] = _strStore->addString(_data->m_threads[i].m_name);
+		numStrings = _strStore->getNumStrings();
+	}
+	else
+	{
+		memset(scratch.m_stringHash, 0, sizeof(uint32_t) * scratch.m_stringHashSize);
+		memset(scratch.m_stringCache, 0, sizeof(const char*) * scratch.m_stringHashSize);
+		for (uint32_t i=0; i<numScopes; ++i)
+		{
+			ProfilerScope& scope = _data->m_scopes[i];
+			scratch.m_scopeNames[i] = addScratchString(scratch, numStrings, scope.m_name);
+			scratch.m_scopeFiles[i] = addScratchString(scratch, numStrings, scope.m_file);
+		}
+		for (uint32_t i=0; i<numThreads; ++i)
+			scratch.m_threadNames[i] = addScratchString(scratch, numStrings, _data->m_threads[i].m_name);
+	}
+
+	// scopes reference unique (name, file, line) call sites by index
+	uint32_t numCallsites = 0;
+	memset(scratch.m_callsiteHash, 0, sizeof(uint32_t) * scratch.m_callsiteHashSize);
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		CallsiteKey key = { scratch.m_scopeNames[i], scratch.m_scopeFiles[i], _data->m_scopes[i].m_line };
+		scratch.m_scopeCallsites[i] = addScratchCallsite(scratch, numCallsites, key);
+	}
+
+	// frame summary, readable without decompression
+	sortScopes(_data->m_scopes, numScopes, scratch.m_order);
+	calculateExclusiveTimes(_data->m_scopes, numScopes, scratch.m_order, scratch.m_exclusiveTimes, scratch.m_lastAtLevel, bounds.m_maxLevel);
+
+	for (uint32_t i=0; i<numCallsites; ++i)
+	{
+		scratch.m_callsiteTimes[i]	= 0;
+		scratch.m_callsiteCounts[i]	= 0;
+		scratch.m_callsiteOrder[i]	= i;
+	}
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		scratch.m_callsiteTimes[scratch.m_scopeCallsites[i]] += scratch.m_exclusiveTimes[i];
+		scratch.m_callsiteCounts[scratch.m_scopeCallsites[i]]++;
+	}
+
+	// call sites are grouped by name, names with the longest exclusive time are kept
+	CallsiteNameOrder nameOrder = { scratch.m_callsites };
+	std::sort(scratch.m_callsiteOrder, scratch.m_callsiteOrder + numCallsites, nameOrder);
+
+	SummaryScope topScopes[RPROF_SUMMARY_SCOPES_MAX];
+	uint32_t numTopScopes = 0;
+
+	for (uint32_t i=0; i<numCallsites;)
+	{
+		SummaryScope scope;
+		scope.m_name			= scratch.m_callsites[scratch.m_callsiteOrder[i]].m_name;
+		scope.m_exclusiveTime	= 0;
+		scope.m_occurences		= 0;
+
+		for (; (i<numCallsites) && (scratch.m_callsites[scratch.m_callsiteOrder[i]].m_name == scope.m_name); ++i)
+		{
+			scope.m_exclusiveTime	+= scratch.m_callsiteTimes[scratch.m_callsiteOrder[i]];
+			scope.m_occurences		+= scratch.m_callsiteCounts[scratch.m_callsiteOrder[i]];
+		}
+
+		uint32_t pos = numTopScopes < RPROF_SUMMARY_SCOPES_MAX ? numTopScopes++ : RPROF_SUMMARY_SCOPES_MAX;
+		for (; pos && (topScopes[pos - 1].m_exclusiveTime < scope.m_exclusiveTime); --pos)
+			if (pos < RPROF_SUMMARY_SCOPES_MAX)
+				topScopes[pos] = topScopes[pos - 1];
+		if (pos < RPROF_SUMMARY_SCOPES_MAX)
+			topScopes[pos] = scope;
+	}
+
+	rprof::FrameHeader header;
+	header.m_signature		= rprof::s_frameSignature;
+	header.m_version		= rprof::s_frameVersion;
+	header.m_headerSize		= sizeof(header);
+	header.m_rawSize		= 0;
+	header.m_clockSource	= _data->m_clockSource;
+	header.m_stringBase		= stringBase;
+	header.m_startTime		= _data->m_startTime;
+	header.m_endTime		= _data->m_endtime;
+	header.m_frequency		= rprofGetClockFrequency();
+	header.m_numScopes		= numScopes;
+	header.m_numThreads		= numThreads;
+	header.m_maxDepth		= numScopes ? bounds.m_maxLevel + 1 : 0;
+	header.m_numTopScopes	= numTopScopes;
+	header.m_dictSize		= _dict ? _dict->m_size : 0;
+	header.m_reserved		= 0;
+
+	for (uint32_t i=0; i<numTopScopes; ++i)
+		header.m_headerSize += sizeof(rprof::FrameTopScope) + (uint32_t)strlen(getSaveString(_strStore, scratch, topScopes[i].m_name)) + 1;
+
+	if (outputSize <= header.m_headerSize)
+	{
+		if (_strStore)
+			_strStore->truncate(stringBase);
+		return 0;
+	}
+
+	// dictionary is copied right in front of the first staging block, so that
+	// LZ4 sees it and payload as contiguous data. Frame dictionary is then
+	// overwritten with start of this frame payload, it is restored on failure.
+	uint8_t* dict = (uint8_t*)scratch.m_blocks - header.m_dictSize;
+	if (header.m_dictSize)
+		memcpy(dict, _dict->m_data, header.m_dictSize);
+
+	void* stream = initCompressionStream(scratch.m_stream, compression, dict, header.m_dictSize);
+	PayloadWriter writer(stream, compression, scratch.m_blocks, output + header.m_headerSize, output + outputSize, _dict ? _dict->m_data : 0);
+
+	writer.write(_data->m_startTime);
+	writer.write(_data->m_endtime);
+	writer.write(_data->m_prevFrameTime);
+	writer.write(_data->m_platformID);
+	writer.write(rprofGetClockFrequency());
+
+	// write string data, indices below stringBase are not stored
+	writer.writeVarint(numStrings - stringBase);
+	for (uint32_t i=stringBase; i<numStrings; ++i)
+		writer.writeStr(getSaveString(_strStore, scratch, i));
+
+	// write thread info
+	writer.writeVarint(numThreads);
+	for (uint32_t i=0; i<numThreads; ++i)
+	{
+		writer.writeVarint(_data->m_threads[i].m_threadID);
+		writer.writeVarint(scratch.m_threadNames[i]);
+	}
+
+	writer.writeVarint(numCallsites);
+	for (uint32_t i=0; i<numCallsites; ++i)
+	{
+		writer.writeVarint(scratch.m_callsites[i].m_name);
+		writer.writeVarint(scratch.m_callsites[i].m_file);
+		writer.writeVarint(scratch.m_callsites[i].m_line);
+	}
+
+	// scopes are grouped by thread and sorted by start time, start is
+	// stored as delta from previous scope start on the same thread
+	const uint32_t* order = scratch.m_order;
+
+	uint32_t numLanes = 0;
+	for (uint32_t i=0; i<numScopes; ++i)
+		if (!i || (_data->m_scopes[order[i]].m_threadID != _data->m_scopes[order[i-1]].m_threadID))
+			++numLanes;
+
+	writer.writeVarint(numScopes);
+	writer.writeVarint(numLanes);
+
+	for (uint32_t laneStart=0; laneStart<numScopes;)
+	{
+		uint64_t threadID = _data->m_scopes[order[laneStart]].m_threadID;
+		uint32_t laneEnd = laneStart;
+		while ((laneEnd < numScopes) && (_data->m_scopes[order[laneEnd]].m_threadID == threadID))
+			++laneEnd;
+
+		writer.writeVarint(threadID);
+		writer.writeVarint(laneEnd - laneStart);
+
+		uint64_t prevStart = 0;
+		for (uint32_t i=laneStart; i<laneEnd; ++i)
+		{
+			ProfilerScope& scope = _data->m_scopes[order[i]];
+			writer.writeVarint(scope.m_start - prevStart);
+			writer.writeVarint(scope.m_end - scope.m_start);
+			writer.writeVarint(scratch.m_scopeCallsites[order[i]]);
+			writer.writeVarint(scope.m_level);
+			prevStart = scope.m_start;
+		}
+
+		laneStart = laneEnd;
+	}
+
+	writer.flush();
+	if (writer.m_failed)
+	{
+		if (_strStore)
+			_strStore->truncate(stringBase);
+		if (_dict)
+			memcpy(_dict->m_data, dict, header.m_dictSize);
+		return 0;
+	}
+
+	header.m_rawSize = writer.m_rawSize;
+	if (_dict)
+		_dict->m_size = writer.m_rawSize < RPROF_SAVE_DICT_SIZE ? writer.m_rawSize : RPROF_SAVE_DICT_SIZE;
+
+	uint8_t* headerPtr = output;
+	writeVar(headerPtr, header);
+	for (uint32_t i=0; i<numTopScopes; ++i)
+	{
+		const char* name = getSaveString(_strStore, scratch, topScopes[i].m_name);
+
+		rprof::FrameTopScope topScope;
+		topScope.m_exclusiveTime	= topScopes[i].m_exclusiveTime;
+		topScope.m_occurences		= topScopes[i].m_occurences;
+		topScope.m_nameSize			= (uint32_t)strlen(name) + 1;
+		writeVar(headerPtr, topScope);
+		memcpy(headerPtr, name, topScope.m_nameSize);
+		headerPtr += topScope.m_nameSize;
+	}
+
+	return (int)(writer.m_out - output);
+}
+
+// Data of a capture file that its frames depend on
+struct FrameDependencies
+{
+	const char* const*	m_strings;		// shared string table
+	uint32_t			m_numStrings;
+	const uint8_t*		m_dict;			// payload of previous frame
+	uint32_t			m_dictSize;
+};
+
+// Loads frame saved by rprofSave or saveFrame, _deps is set for frames of a
+// capture file, that can reference strings of earlier frames and use previous
+// frame as dictionary.
+// Scopes, stats, threads and strings are placed in a single memory block that
+// starts with scopes, in arena memory when _arenaMemory is set, allocated and
+// owned by the frame (see rprofRelease) otherwise.
+static void loadFrame(ProfilerFrame* _data, const void* _buffer, size_t _bufferSize, const FrameDependencies* _deps, ProfilerFrameArena& _arena, bool _arenaMemory)
+{
+	const uint32_t prefixSize = 3 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+	const char* const*	sharedStrings		= _deps ? _deps->m_strings : 0;
+	uint32_t			numSharedStrings	= _deps ? _deps->m_numStrings : 0;
+
+	rprof::FrameHeader header;
+	int decomp = decompressFrame(_buffer, _bufferSize, _arena.m_raw, header, _deps ? _deps->m_dict : 0, _deps ? _deps->m_dictSize : 0);
+	if (decomp < (int)prefixSize)
+	{
+		memset(_data, 0, sizeof(ProfilerFrame));
+		return;
+	}
+
+	uint8_t* buffer = &_arena.m_raw[0];
+	uint8_t* bufferEnd = buffer + decomp;
+
+	readVar(buffer, _data->m_startTime);
+	readVar(buffer, _data->m_endtime);
+	readVar(buffer, _data->m_prevFrameTime);
+	readVar(buffer, _data->m_platformID);
+	readVar(buffer, _data->m_CPUFrequency);
+	_data->m_clockSource = header.m_clockSource;
+
+	// scope name and file are read as string indices and resolved below
+	if (header.m_version)
+		readScopes(_arena, buffer, bufferEnd, _data->m_startTime);
+	else
+		readScopesLegacy(_arena, buffer, bufferEnd);
+
+	// scope can not be deeper than number of scopes, such records are corrupt
+	// and dropped, the rest of the frame is kept
+	uint32_t numRead = (uint32_t)_arena.m_scopes.size();
+	uint32_t numScopes = 0;
+	for (uint32_t i=0; i<numRead; ++i)
+		if (_arena.m_scopes[i].m_level < numRead)
+			_arena.m_scopes[numScopes++] = _arena.m_scopes[i];
+	_arena.m_scopes.resize(numScopes);
+
+	uint32_t numThreads	= (uint32_t)_arena.m_threads.size();
+	uint32_t maxLevel	= numScopes ? getMaxLevel(&_arena.m_scopes[0], numScopes) : 0;
+
+	// strings below stringBase are in the shared table, index numStrings is
+	// the empty string used for invalid indices
+	uint32_t stringBase	= header.m_stringBase;
+	uint32_t numStrings	= stringBase + (uint32_t)_arena.m_strings.size();
+
+	// only referenced strings are copied, once each
+	const uint32_t invalid = 0xffffffff;
+	std::vector<uint32_t>& stringOffsets = _arena.m_stringOffsets;
+	stringOffsets.assign(numStrings + 1, invalid);
+
+	uint32_t stringsSize = 0;
+	for (uint32_t i=0; i<numScopes*2 + numThreads; ++i)
+	{
+		uintptr_t idx;
+		if (i < numScopes*2)
+			idx = (uintptr_t)((i & 1) ? _arena.m_scopes[i/2].m_file : _arena.m_scopes[i/2].m_name);
+		else
+			idx = (uintptr_t)_arena.m_threads[i - numScopes*2].m_name;
+		if (idx > numStrings)
+			idx = numStrings;
+
+		if (stringOffsets[idx] != invalid)
+			continue;
+
+		uint32_t length = 0;
+		if (idx < stringBase)
+			length = (idx < numSharedStrings) ? (uint32_t)strlen(sharedStrings[idx]) : 0;
+		else
+		if (idx < numStrings)
+			length = _arena.m_strings[idx - stringBase].m_length;
+
+		stringOffsets[idx]	 = stringsSize;
+		stringsSize			+= length + 1;
+	}
+
+	// extra scopes and stats are space for viewer - m_scopesStats
+	size_t scopesSize	= sizeof(ProfilerScope) * numScopes * 2;
+	size_t statsSize	= sizeof(ProfilerScopeStats) * numScopes * 2;
+	size_t threadsSize	= sizeof(ProfilerThread) * numThreads;
+	size_t memorySize	= (scopesSize + statsSize + threadsSize + stringsSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+	if (!memorySize)
+		memorySize = 1;
+
+	uint64_t* memory;
+	if (_arenaMemory)
+	{
+		if (_arena.m_memory.size() < memorySize)
+			_arena.m_memory.resize(memorySize);
+		memory = &_arena.m_memory[0];
+	}
+	else
+		memory = new uint64_t[memorySize];
+
+	uint8_t* memoryPtr = (uint8_t*)memory;
+	_data->m_numScopes		= numScopes;
+	_data->m_numThreads		= numThreads;
+	_data->m_scopes			= (ProfilerScope*)memoryPtr;
+	_data->m_scopesStats	= &_data->m_scopes[numScopes];
+	_data->m_scopeStatsInfo	= (ProfilerScopeStats*)(memoryPtr + scopesSize);
+	_data->m_threads		= (ProfilerThread*)(memoryPtr + scopesSize + statsSize);
+	char* strings			= (char*)(memoryPtr + scopesSize + statsSize + threadsSize);
+
+	for (uint32_t i=0; i<=numStrings; ++i)
+	{
+		if (stringOffsets[i] == invalid)
+			continue;
+
+		char* str = strings + stringOffsets[i];
+		if (i < stringBase)
+			strcpy(str, (i < numSharedStrings) ? sharedStrings[i] : "");
+		else
+		if (i < numStrings)
+		{
+			const StringRef& ref = _arena.m_strings[i - stringBase];
+			memcpy(str, ref.m_str, ref.m_length);
+			str[ref.m_length] = 0;
+		}
+		else
+			str[0] = 0;
+	}
+
+	// stats are aggregated by name index, invalid indices share the empty name slot
+	std::vector<uint32_t>& nameIndices = _arena.m_nameIndices;
+	nameIndices.resize(numScopes);
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		ProfilerScope& scope = _data->m_scopes[i];
+		scope = _arena.m_scopes[i];
+
+		uintptr_t idx = (uintptr_t)scope.m_name;
+		nameIndices[i] = (idx < numStrings) ? (uint32_t)idx : numStrings;
+		scope.m_name = strings + stringOffsets[nameIndices[i]];
+
+		idx = (uintptr_t)scope.m_file;
+		scope.m_file = strings + stringOffsets[(idx < numStrings) ? (uint32_t)idx : numStrings];
+	}
+
+	for (uint32_t i=0; i<numScopes*2; ++i)
+		_data->m_scopes[i].m_stats = &_data->m_scopeStatsInfo[i];
+
+	for (uint32_t i=0; i<numThreads; ++i)
+	{
+		ProfilerThread& t = _data->m_threads[i];
+		t = _arena.m_threads[i];
+
+		uintptr_t idx = (uintptr_t)t.m_name;
+		t.m_name = strings + stringOffsets[(idx < numStrings) ? (uint32_t)idx : numStrings];
+	}
+
+	// process frame data
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		ProfilerScope& scope = _data->m_scopes[i];
+		scope.m_stats->m_inclusiveTime	= scope.m_end - scope.m_start;
+		scope.m_stats->m_occurences		= 0;
+	}
+
+	if (numScopes)
+	{
+		_arena.m_order.resize(numScopes);
+		_arena.m_lastAtLevel.resize(maxLevel + 1);
+		_arena.m_exclusiveTimes.resize(numScopes);
+
+		uint64_t* exclusiveTimes = &_arena.m_exclusiveTimes[0];
+		sortScopes(_data->m_scopes, numScopes, &_arena.m_order[0]);
+		calculateExclusiveTimes(_data->m_scopes, numScopes, &_arena.m_order[0], exclusiveTimes, &_arena.m_lastAtLevel[0], maxLevel);
+		for (uint32_t i=0; i<numScopes; ++i)
+			_data->m_scopes[i].m_stats->m_exclusiveTime = exclusiveTimes[i];
+	}
+
+	_data->m_numScopesStats	= 0;
+
+	std::vector<uint32_t>& statsIndices = _arena.m_statsIndices;
+	statsIndices.assign(numStrings + 1, invalid);
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		ProfilerScope& scopeI = _data->m_scopes[i];
+
+		scopeI.m_stats->m_inclusiveTimeTotal = scopeI.m_stats->m_inclusiveTime;
+		scopeI.m_stats->m_exclusiveTimeTotal = scopeI.m_stats->m_exclusiveTime;
+
+		uint32_t& statsIndex = statsIndices[nameIndices[i]];
+		if (statsIndex == invalid)
+		{
+			statsIndex = _data->m_numScopesStats++;
+			ProfilerScope& scope = _data->m_scopesStats[statsIndex];
+			scope						= scopeI;
+			scope.m_stats->m_occurences	= 1;
+		}
+		else
+		{
+			ProfilerScope& scope = _data->m_scopesStats[statsIndex];
+			scope.m_stats->m_inclusiveTimeTotal += scopeI.m_stats->m_inclusiveTime;
+			scope.m_stats->m_exclusiveTimeTotal += scopeI.m_stats->m_exclusiveTime;
+			scope.m_stats->m_occurences++;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------
+ * Capture files
+ *------------------------------------------------------------------------*/
+struct ProfilerCapture
+{
+	rprof::MappedFile				m_file;
+	const ProfilerFrameIndex*		m_index;
+	std::vector<ProfilerFrameIndex>	m_indexStorage;
+	uint32_t						m_numFrames;
+	uint64_t						m_clockFrequency;
+	std::vector<const char*>		m_strings;			// shared string table
+	std::vector<std::string>		m_stringStorage;	// table rebuilt by scanning
+	uint64_t						m_id;				// unique, identifies frames decompressed to arenas
+	ProfilerFrameArena				m_arena;			// for loads without user arena
+};
+
+static std::atomic<uint64_t> s_captureID(0);
+
+// Reads frame metadata by decompressing frame data
+static bool readFrameInfo(const uint8_t* _data, uint32_t _size, ProfilerFrameIndex& _entry, uint64_t& _frequency, std::vector<uint8_t>& _buffer)
+{
+	ProfilerFrameSummary summary;
+	if (readFrameSummary(_data, _size, &summary))
+	{
+		_entry.m_startTime	= summary.m_startTime;
+		_entry.m_endTime	= summary.m_endTime;
+		_entry.m_numScopes	= summary.m_numScopes;
+		_entry.m_numThreads	= summary.m_numThreads;
+		_entry.m_reserved	= 0;
+		_frequency			= summary.m_CPUFrequency;
+		return true;
+	}
+
+	rprof::FrameHeader header;
+	int decomp = decompressFrame(_data, _size, _buffer, header);
+
+	// see rprofSave for layout
+	const uint32_t scopesOffset	= 3 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t);
+	const uint32_t scopeSize	= 3 * sizeof(uint64_t) + 4 * sizeof(uint32_t);
+	if (decomp < (int)(scopesOffset + sizeof(uint32_t)))
+		return false;
+
+	uint8_t* buffer = &_buffer[0];
+	uint64_t dummy64;
+	uint32_t dummy32;
+
+	_entry.m_numThreads	= 0;
+	_entry.m_reserved	= 0;
+	readVar(buffer, _entry.m_startTime);
+	readVar(buffer, _entry.m_endTime);
+	readVar(buffer, dummy64);	// prevFrameTime
+	readVar(buffer, dummy32);	// platformID
+	readVar(buffer, _frequency);
+	readVar(buffer, _entry.m_numScopes);
+
+	uint64_t threadsOffset = scopesOffset + sizeof(uint32_t) + (uint64_t)_entry.m_numScopes * scopeSize;
+	if (threadsOffset + sizeof(uint32_t) <= (uint64_t)decomp)
+	{
+		buffer = &_buffer[(size_t)threadsOffset];
+		readVar(buffer, _entry.m_numThreads);
+	}
+	return true;
+}
+
+// Uses index table at the end of the file, if present and valid
+static bool readFrameIndexTable(ProfilerCapture* _capture)
+{
+	using namespace rprof;
+
+	const uint8_t*	data		= _capture->m_file.getData();
+	uint64_t		fileSize	= _capture->m_file.getSize();
+
+	MultiFrameTrailer trailer;
+	if (fileSize < sizeof(MultiFrameHeader) + sizeof(trailer))
+		return false;
+	memcpy(&trailer, data + fileSize - sizeof(trailer), sizeof(trailer));
+
+	if ((trailer.m_signature != s_multiFrameSignature) ||
+		(trailer.m_version != s_multiFrameVersion))
+		return false;
+
+	// shared string table is between index and trailer
+	uint64_t indexEnd = fileSize - sizeof(trailer);
+	MultiFrameStrings strings;
+	if (indexEnd < sizeof(MultiFrameHeader) + sizeof(strings))
+		return false;
+	indexEnd -= sizeof(strings);
+	memcpy(&strings, data + indexEnd, sizeof(strings));
+
+	if ((strings.m_offset > indexEnd) || (strings.m_size != indexEnd - strings.m_offset))
+		return false;
+	indexEnd = strings.m_offset;
+
+	uint64_t indexSize = (uint64_t)trailer.m_numFrames * sizeof(ProfilerFrameIndex);
+	if ((trailer.m_indexOffset < sizeof(MultiFrameHeader)) ||
+		(trailer.m_indexOffset + indexSize != indexEnd))
+		return false;
+
+	const uint8_t* index = data + trailer.m_indexOffset;
+
+	// index is used in place when aligned, copied otherwise
+	if ((uintptr_t)index % sizeof(uint64_t) == 0)
+		_capture->m_index = (const ProfilerFrameIndex*)index;
+	else
+	{
+		_capture->m_indexStorage.resize(trailer.m_numFrames);
+		if (trailer.m_numFrames)
+			memcpy(&_capture->m_indexStorage[0], index, (size_t)indexSize);
+		_capture->m_index = _capture->m_indexStorage.empty() ? 0 : &_capture->m_indexStorage[0];
+	}
+
+	_capture->m_numFrames		= trailer.m_numFrames;
+	_capture->m_clockFrequency	= trailer.m_clockFrequency;
+
+	// reject entries pointing outside of frame data
+	for (uint32_t i=0; i<trailer.m_numFrames; ++i)
+	{
+		const ProfilerFrameIndex& entry = _capture->m_index[i];
+		if ((entry.m_offset > trailer.m_indexOffset) || (entry.m_size > trailer.m_indexOffset - entry.m_offset))
+			return false;
+	}
+
+	// strings are used in place
+	const char* str		= (const char*)data + strings.m_offset;
+	const char* strEnd	= str + strings.m_size;
+	_capture->m_strings.clear();
+	_capture->m_strings.reserve(strings.m_numStrings);
+	for (uint32_t i=0; i<strings.m_numStrings; ++i)
+	{
+		const char* end = (const char*)memchr(str, 0, (size_t)(strEnd - str));
+		if (!end)
+			return false;
+		_capture->m_strings.push_back(str);
+		str = end + 1;
+	}
+	return true;
+}
+
+// Shared string table index of first string stored in frame, zero if frame
+// does not reference strings of earlier frames
+static uint32_t readFrameStringBase(const uint8_t* _data, uint32_t _size)
+{
+	rprof::FrameHeader header;
+	readFrameHeader(_data, _size, header);
+	return header.m_stringBase;
+}
+
+static const uint32_t s_invalidFrame = 0xffffffff;
+
+static inline uint32_t readCaptureFrameDictSize(ProfilerCapture* _capture, uint32_t _frame)
+{
+	const ProfilerFrameIndex& entry = _capture->m_index[_frame];
+	rprof::FrameHeader header;
+	readFrameHeader(_capture->m_file.getData() + entry.m_offset, entry.m_size, header);
+	return header.m_dictSize;
+}
+
+// Decompresses frame payload to arena. Frame compressed with previous frame as
+// dictionary needs it decompressed first, frames are decompressed starting
+// from the closest one without dictionary or from the last one decompressed
+// to the arena. Returns decompressed size, -1 on failure.
+static int decodeCaptureFrame(ProfilerCapture* _capture, ProfilerFrameArena& _arena, uint32_t _frame)
+{
+	uint32_t lastFrame = _arena.m_captureID == _capture->m_id ? _arena.m_captureFrame : s_invalidFrame;
+	if (lastFrame == _frame)
+		return (int)_arena.m_captureRawSize;
+
+	uint32_t first = _frame;
+	while (first && (first - 1 != lastFrame) && readCaptureFrameDictSize(_capture, first))
+		--first;
+
+	const uint8_t* data = _capture->m_file.getData();
+	for (uint32_t i=first; i<=_frame; ++i)
+	{
+		const ProfilerFrameIndex& entry = _capture->m_index[i];
+		bool hasDict = i && (i - 1 == lastFrame);
+
+		rprof::FrameHeader header;
+		int decomp = decompressFrame(data + entry.m_offset, entry.m_size, _arena.m_captureRawScratch, header,
+									hasDict ? &_arena.m_captureRaw[0] : 0, hasDict ? _arena.m_captureRawSize : 0);
+		if (decomp < 0)
+		{
+			_arena.m_captureID = 0;
+			return -1;
+		}
+
+		_arena.m_captureRaw.swap(_arena.m_captureRawScratch);
+		_arena.m_captureID		= _capture->m_id;
+		_arena.m_captureFrame	= i;
+		_arena.m_captureRawSize	= (uint32_t)decomp;
+		lastFrame				= i;
+	}
+	return (int)_arena.m_captureRawSize;
+}
+
+static bool getCaptureFrameDependencies(ProfilerCapture* _capture, ProfilerFrameArena& _arena, uint32_t _frame, FrameDependencies& _deps)
+{
+	_deps.m_strings		= _capture->m_strings.empty() ? 0 : &_capture->m_strings[0];
+	_deps.m_numStrings	= (uint32_t)_capture->m_strings.size();
+	_deps.m_dict		= 0;
+	_deps.m_dictSize	= 0;
+
+	if (!readCaptureFrameDictSize(_capture, _frame))
+		return true;
+
+	if (!_frame || (decodeCaptureFrame(_capture, _arena, _frame - 1) < 0))
+		return false;
+
+	_deps.m_dict		= &_arena.m_captureRaw[0];
+	_deps.m_dictSize	= _arena.m_captureRawSize;
+	return true;
+}
+
+// Rebuilds shared string table from strings stored in frames, only frames
+// after which the table grows have to be decompressed
+static void scanFrameStrings(ProfilerCapture* _capture)
+{
+	const uint8_t* data = _capture->m_file.getData();
+
+	std::vector<std::string>& strings = _capture->m_stringStorage;
+	strings.clear();
+
+	for (uint32_t i=0; i<_capture->m_numFrames; ++i)
+	{
+		const ProfilerFrameIndex& entry = _capture->m_index[i];
+		uint32_t base = readFrameStringBase(data + entry.m_offset, entry.m_size);
+
+		if (i + 1 < _capture->m_numFrames)
+		{
+			const ProfilerFrameIndex& next = _capture->m_index[i + 1];
+			if (readFrameStringBase(data + next.m_offset, next.m_size) <= base)
+				continue;
+		}
+
+		rprof::FrameHeader header;
+		if (!readFrameHeader(data + entry.m_offset, entry.m_size, header))
+			continue;
+
+		int decomp = decodeCaptureFrame(_capture, _capture->m_arena, i);
+		if (decomp < (int)(3 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t)))
+			continue;
+
+		// see saveFrame for layout
+		std::vector<uint8_t>& raw = _capture->m_arena.m_captureRaw;
+		uint8_t* buffer		= &raw[3 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t)];
+		uint8_t* bufferEnd	= &raw[0] + decomp;
+
+		strings.resize(base);
+		uint32_t numStrings = (uint32_t)readVarint(buffer, bufferEnd);
+		for (uint32_t j=0; j<numStrings; ++j)
+		{
+			uint32_t len;
+			if (bufferEnd - buffer < (ptrdiff_t)sizeof(len))
+				break;
+			readVar(buffer, len);
+			if ((uint32_t)(bufferEnd - buffer) < len)
+				break;
+			strings.push_back(std::string((const char*)buffer, len));
+			buffer += len;
+		}
+	}
+
+	_capture->m_strings.resize(strings.size());
+	for (uint32_t i=0; i<strings.size(); ++i)
+		_capture->m_strings[i] = strings[i].c_str();
+}
+
+// Builds index by reading every frame, for files without index table
+static void scanFrameIndex(ProfilerCapture* _capture, uint64_t _offset)
+{
+	const uint8_t*	data		= _capture->m_file.getData();
+	uint64_t		fileSize	= _capture->m_file.getSize();
+
+	std::vector<uint8_t> buffer;
+	std::vector<ProfilerFrameIndex>& index = _capture->m_indexStorage;
+	index.clear();
+
+	while (_offset + sizeof(uint32_t) <= fileSize)
+	{
+		uint32_t size;
+		memcpy(&size, data + _offset, sizeof(uint32_t));
+
+		// truncated frame, recording was interrupted
+		if (!size || (size > fileSize - _offset - sizeof(uint32_t)))
+			break;
+
+		ProfilerFrameIndex entry;
+		entry.m_offset	= _offset + sizeof(uint32_t);
+		entry.m_size	= size;
+		if (!readFrameInfo(data + entry.m_offset, size, entry, _capture->m_clockFrequency, buffer))
+			break;
+
+		index.push_back(entry);
+		_offset = entry.m_offset + size;
+	}
+
+	_capture->m_index		= index.empty() ? 0 : &index[0];
+	_capture->m_numFrames	= (uint32_t)index.size();
+
+	scanFrameStrings(_capture);
+}
+
+/*--------------------------------------------------------------------------
+ * Parallel frame processing
+ *------------------------------------------------------------------------*/
+
+// Frames are given out in groups starting with a frame compressed without
+// dictionary (see RPROF_SAVE_DICT_INTERVAL) so no frame is decompressed by
+// more than one worker. Each worker owns a range of groups and takes them from
+// the front, idle worker steals back half of the range of another worker.
+struct FrameWorker
+{
+	std::atomic<uint64_t>		m_groups;			// first group in low, end group in high 32 bits
+	uint8_t						m_padding[64 - sizeof(uint64_t)];
+	struct FrameWorkers*		m_workers;
+	ProfilerFrameArena			m_arena;
+	uint32_t					m_index;
+	uint32_t					m_numProcessed;
+#if RPROF_THREADS_SUPPORTED
+	rprof::Thread				m_thread;
+#endif
+};
+
+struct FrameWorkers
+{
+	ProfilerCapture*			m_capture;
+	ProfilerFrameCallback		m_callback;
+	void*						m_userData;
+	FrameWorker*				m_workers;
+	uint32_t					m_numWorkers;
+	uint32_t					m_firstFrame;
+	uint32_t					m_endFrame;
+};
+
+static inline uint64_t packFrameGroups(uint32_t _begin, uint32_t _end)
+{
+	return ((uint64_t)_end << 32) | _begin;
+}
+
+static bool popFrameGroup(FrameWorker& _worker, uint32_t& _group)
+{
+	uint64_t groups = _worker.m_groups.load();
+	for (;;)
+	{
+		uint32_t begin	= (uint32_t)groups;
+		uint32_t end	= (uint32_t)(groups >> 32);
+		if (begin >= end)
+			return false;
+
+		if (_worker.m_groups.compare_exchange_weak(groups, packFrameGroups(begin + 1, end)))
+		{
+			_group = begin;
+			return true;
+		}
+	}
+}
+
+// Groups in transit between workers are in neither range, worker finding no
+// groups to steal leaves them to the stealing worker.
+static bool stealFrameGroups(FrameWorker& _worker)
+{
+	FrameWorkers& workers = *_worker.m_workers;
+	for (uint32_t i=1; i<workers.m_numWorkers; ++i)
+	{
+		FrameWorker& victim = workers.m_workers[(_worker.m_index + i) % workers.m_numWorkers];
+
+		uint64_t groups = victim.m_groups.load();
+		for (;;)
+		{
+			uint32_t begin	= (uint32_t)groups;
+			uint32_t end	= (uint32_t)(groups >> 32);
+			if (begin >= end)
+				break;
+
+			uint32_t middle = begin + (end - begin) / 2;
+			if (victim.m_groups.compare_exchange_weak(groups, packFrameGroups(begin, middle)))
+			{
+				_worker.m_groups.store(packFrameGroups(middle, end));
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static void processFrames(void* _worker)
+{
+	FrameWorker& worker		= *(FrameWorker*)_worker;
+	FrameWorkers& workers	= *worker.m_workers;
+
+	for (;;)
+	{
+		uint32_t group;
+		if (!popFrameGroup(worker, group))
+		{
+			if (!stealFrameGroups(worker))
+				break;
+			continue;
+		}
+
+		// groups are aligned to dictionary intervals, first and last may be partial
+		uint32_t first	= std::max(group * RPROF_SAVE_DICT_INTERVAL, workers.m_firstFrame);
+		uint32_t end	= std::min((group + 1) * RPROF_SAVE_DICT_INTERVAL, workers.m_endFrame);
+		for (uint32_t i=first; i<end; ++i)
+		{
+			ProfilerFrame data;
+			if (!rprofLoadCaptureFrameToArena(workers.m_capture, i, &data, &worker.m_arena))
+				continue;
+
+			workers.m_callback(&data, i, worker.m_index, workers.m_userData);
+			worker.m_numProcessed++;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------
+ * Call paths
+ *------------------------------------------------------------------------*/
+
+struct ProfilerCallTree
+{
+	std::vector<ProfilerCallPath>				m_paths;
+	std::unordered_map<uint64_t, uint32_t>		m_pathIndices;		// parent path in high, name in low 32 bits
+	std::unordered_map<std::string, uint32_t>	m_nameIndices;
+	std::vector<const char*>					m_names;			// keys of m_nameIndices
+	uint64_t									m_frequency;
+	uint32_t									m_numFrames;
+
+	// per frame scratch
+	std::unordered_map<const char*, uint32_t>	m_pointerNames;
+	std::vector<uint32_t>						m_order;
+	std::vector<uint32_t>						m_scopePaths;
+	std::vector<uint32_t>						m_lastAtLevel;
+	std::vector<uint64_t>						m_exclusiveTimes;
+};
+
+// Scopes with the same name in a frame share the pointer, only first one per
+// frame is looked up by name
+static uint32_t getCallTreeName(ProfilerCallTree& _tree, const char* _name)
+{
+	std::unordered_map<const char*, uint32_t>::iterator it = _tree.m_pointerNames.find(_name);
+	if (it != _tree.m_pointerNames.end())
+		return it->second;
+
+	std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> name = _tree.m_nameIndices.insert(std::make_pair(std::string(_name ? _name : ""), (uint32_t)_tree.m_names.size()));
+	if (name.second)
+		_tree.m_names.push_back(name.first->first.c_str());
+
+	_tree.m_pointerNames[_name] = name.first->second;
+	return name.first->second;
+}
+
+// Scopes are visited in sortScopes order, parent of a scope is the last
+// visited scope one level up on the same thread, if it contains the scope.
+// Call path of a scope is its name under call path of its parent.
+static void addToCallTree(ProfilerCallTree& _tree, const ProfilerFrame* _data)
+{
+	const uint32_t invalid = 0xffffffff;
+	const ProfilerScope* scopes = _data->m_scopes;
+	uint32_t numScopes = _data->m_numScopes;
+	uint32_t maxLevel = getMaxLevel(scopes, numScopes);
+
+	_tree.m_order.resize(numScopes);
+	_tree.m_scopePaths.resize(numScopes);
+	_tree.m_exclusiveTimes.resize(numScopes);
+	_tree.m_lastAtLevel.assign(maxLevel + 1, invalid);
+	_tree.m_pointerNames.clear();
+
+	sortScopes(scopes, numScopes, &_tree.m_order[0]);
+
+	for (uint32_t i=0; i<numScopes; ++i)
+		_tree.m_exclusiveTimes[i] = scopes[i].m_end - scopes[i].m_start;
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		uint32_t index = _tree.m_order[i];
+		const ProfilerScope& scope = scopes[index];
+
+		uint32_t parentPath = RPROF_CALL_PATH_ROOT;
+		uint32_t parentIndex = scope.m_level ? _tree.m_lastAtLevel[scope.m_level - 1] : invalid;
+		if (parentIndex != invalid)
+		{
+			const ProfilerScope& parent = scopes[parentIndex];
+			if ((parent.m_threadID == scope.m_threadID) && (parent.m_start <= scope.m_start) && (parent.m_end >= scope.m_end))
+			{
+				parentPath = _tree.m_scopePaths[parentIndex];
+				_tree.m_exclusiveTimes[parentIndex] -= std::min(scope.m_end - scope.m_start, _tree.m_exclusiveTimes[parentIndex]);
+			}
+		}
+		_tree.m_lastAtLevel[scope.m_level] = index;
+
+		uint32_t name = getCallTreeName(_tree, scope.m_name);
+		std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> path = _tree.m_pathIndices.insert(std::make_pair(((uint64_t)parentPath << 32) | name, (uint32_t)_tree.m_paths.size()));
+		if (path.second)
+		{
+			ProfilerCallPath callPath;
+			callPath.m_name				= _tree.m_names[name];
+			callPath.m_parent			= parentPath;
+			callPath.m_depth			= parentPath == RPROF_CALL_PATH_ROOT ? 0 : _tree.m_paths[parentPath].m_depth + 1;
+			callPath.m_inclusiveTime	= 0;
+			callPath.m_exclusiveTime	= 0;
+			callPath.m_occurences		= 0;
+			_tree.m_paths.push_back(callPath);
+		}
+		_tree.m_scopePaths[index] = path.first->second;
+	}
+
+	// times of frames with different clock frequency are converted to the one of first frame
+	if (!_tree.m_frequency)
+		_tree.m_frequency = _data->m_CPUFrequency;
+
+	bool convert = _data->m_CPUFrequency && (_data->m_CPUFrequency != _tree.m_frequency);
+	double scale = convert ? (double)_tree.m_frequency / (double)_data->m_CPUFrequency : 1.0;
+
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		uint64_t inclusiveTime = scopes[i].m_end - scopes[i].m_start;
+		uint64_t exclusiveTime = _tree.m_exclusiveTimes[i];
+		if (convert)
+		{
+			inclusiveTime = (uint64_t)((double)inclusiveTime * scale);
+			exclusiveTime = (uint64_t)((double)exclusiveTime * scale);
+		}
+
+		ProfilerCallPath& path = _tree.m_paths[_tree.m_scopePaths[i]];
+		path.m_inclusiveTime	+= inclusiveTime;
+		path.m_exclusiveTime	+= exclusiveTime;
+		path.m_occurences++;
+	}
 }
 
-template <typename T>
-static inline void writeVar(uint8_t*& _buffer, T _var)
+struct DiffScopeOrder
 {
-	memoryCopy(_buffer, &_var, sizeof(T));
-	_buffer += sizeof(T);
-}
+	bool operator()(const ProfilerDiffScope& _a, const ProfilerDiffScope& _b) const
+	{
+		double exclusiveA = fabs(_a.m_exclusiveTime[1] - _a.m_exclusiveTime[0]);
+		double exclusiveB = fabs(_b.m_exclusiveTime[1] - _b.m_exclusiveTime[0]);
+		if (exclusiveA != exclusiveB)
+			return exclusiveA > exclusiveB;
 
-static inline void writeStr(uint8_t*& _buffer, const char* _str)
-{
-	uint32_t len = (uint32_t)strlen(_str);
-	writeVar(_buffer, len);
-	memoryCopy(_buffer, _str, len);
-	_buffer += len;
-}
+		double inclusiveA = fabs(_a.m_inclusiveTime[1] - _a.m_inclusiveTime[0]);
+		double inclusiveB = fabs(_b.m_inclusiveTime[1] - _b.m_inclusiveTime[0]);
+		if (inclusiveA != inclusiveB)
+			return inclusiveA > inclusiveB;
 
-template <typename T>
-static inline void readVar(uint8_t*& _buffer, T& _var)
-{
-	memoryCopy(&_var, _buffer, sizeof(T));
-	_buffer += sizeof(T);
-}
-	
-static inline char* readString(uint8_t*& _buffer)
+		return strcmp(_a.m_name, _b.m_name) < 0;
+	}
+};
+
+// Paths of both trees are visited parents first. Scope of a path is found by
+// name and, when matching by call path, by the scope of its parent path.
+static void diffCallTrees(ProfilerCallTree* _trees[2], uint32_t _mode, std::vector<ProfilerDiffScope>& _scopes)
 {
-	uint32_t len;
-	readVar(_buffer, len);
-	char* str = new char[len+1];
-	memoryCopy(str, _buffer, len);
-	str[len] = 0;
-	_buffer += len;
-	return str;
+	std::unordered_map<std::string, uint32_t>	names;
+	std::unordered_map<uint64_t, uint32_t>		scopeIndices;	// parent scope in high, name in low 32 bits
+	std::vector<uint32_t>						pathScopes;
+
+	for (uint32_t i=0; i<2; ++i)
+	{
+		const ProfilerCallTree& tree = *_trees[i];
+		double scale = tree.m_frequency && tree.m_numFrames ? 1000.0 / ((double)tree.m_frequency * (double)tree.m_numFrames) : 0.0;
+		double frames = tree.m_numFrames ? 1.0 / (double)tree.m_numFrames : 0.0;
+
+		// paths with equal name share the pointer within a tree
+		std::unordered_map<const char*, uint32_t> pointerNames;
+
+		pathScopes.resize(tree.m_paths.size());
+		for (size_t j=0; j<tree.m_paths.size(); ++j)
+		{
+			const ProfilerCallPath& path = tree.m_paths[j];
+
+			uint32_t name;
+			std::unordered_map<const char*, uint32_t>::iterator it = pointerNames.find(path.m_name);
+			if (it != pointerNames.end())
+				name = it->second;
+			else
+			{
+				name = names.insert(std::make_pair(std::string(path.m_name), (uint32_t)names.size())).first->second;
+				pointerNames[path.m_name] = name;
+			}
+
+			uint32_t parent = (_mode == RPROF_DIFF_NAME) || (path.m_parent == RPROF_CALL_PATH_ROOT) ? RPROF_CALL_PATH_ROOT : pathScopes[path.m_parent];
+			std::pair<std::unordered_map<uint64_t, uint32_t>::iterator, bool> scope = scopeIndices.insert(std::make_pair(((uint64_t)parent << 32) | name, (uint32_t)_scopes.size()));
+			if (scope.second)
+			{
+				ProfilerDiffScope diffScope;
+				memset(&diffScope, 0, sizeof(diffScope));
+				diffScope.m_name	= path.m_name;
+				diffScope.m_path[0]	= RPROF_CALL_PATH_ROOT;
+				diffScope.m_path[1]	= RPROF_CALL_PATH_ROOT;
+				_scopes.push_back(diffScope);
+			}
+			pathScopes[j] = scope.first->second;
+
+			ProfilerDiffScope& diffScope = _scopes[scope.first->second];
+			if (_mode == RPROF_DIFF_CALL_PATH)
+				diffScope.m_path[i] = (uint32_t)j;
+			diffScope.m_inclusiveTime[i]	+= (double)path.m_inclusiveTime * scale;
+			diffScope.m_exclusiveTime[i]	+= (double)path.m_exclusiveTime * scale;
+			diffScope.m_occurences[i]		+= (double)path.m_occurences * frames;
+		}
+	}
+
+	std::sort(_scopes.begin(), _scopes.end(), DiffScopeOrder());
 }
 
-const char* duplicateString(const char* _str)
+/*--------------------------------------------------------------------------
+ * Linux clock, invariant TSC when usable, CLOCK_MONOTONIC otherwise
+ *------------------------------------------------------------------------*/
+#if RPROF_PLATFORM_LINUX
+static inline uint64_t linuxClockNs(clockid_t _clock)
 {
-	if (!_str)
-		return nullptr;
-	char* str = new char[strlen(_str)+1];
-	strcpy(str, _str);
-	return str;
+	struct timespec ts;
+	clock_gettime(_clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
 }
 
-struct StringStore
+#if defined(__x86_64__) || defined(__i386__)
+static bool linuxTSCUsable()
 {
-	typedef std::unordered_map<std::string, uint32_t> StringToIndexType;
-	typedef std::unordered_map<uint32_t, std::string> IndexToStringType;
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || (eax < 0x80000007))
+		return false;
 
-	uint32_t			m_totalSize;
-	StringToIndexType	m_stringIndexMap;
-	IndexToStringType	m_strings;
+	__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+	if (!(edx & (1 << 8)))	// invariant TSC
+		return false;
 
-	StringStore()
-		: m_totalSize(0)
+	// kernel switches away from TSC when it finds it unstable or not synchronized between cores
+	FILE* file = fopen("/sys/devices/system/clocksource/clocksource0/current_clocksource", "r");
+	if (file)
 	{
+		char source[32] = { 0 };
+		char* read = fgets(source, sizeof(source), file);
+		fclose(file);
+		if (read && (strncmp(source, "tsc", 3) != 0))
+			return false;
 	}
 
-	void addString(const char* _str)
-	{
-		StringToIndexType::iterator it = m_stringIndexMap.find(_str);
-		if (it == m_stringIndexMap.end())
-		{
-			uint32_t index = (uint32_t)m_stringIndexMap.size();
-			m_totalSize				+= 4 + (uint32_t)strlen(_str);	// see writeStr for details
-			m_stringIndexMap[_str]	 = index;
-			m_strings[index]		 = _str;
-		}
-	}
+	return true;
+}
+#endif
+
+struct LinuxClock
+{
+	uint64_t	m_frequency;
+	uint8_t		m_source;
+	bool		m_calibrated;
+};
 
-	uint32_t getString(const char* _str)
+// Constant initialized, CLOCK_MONOTONIC until calibrated by rprofInit
+static LinuxClock s_linuxClock = { 1000000000, RPROF_CLOCK_MONOTONIC, false };
+
+// Switches to TSC once, takes ~50ms so it is done in rprofInit and not on first clock read
+static void linuxClockCalibrate()
+{
+	if (s_linuxClock.m_calibrated)
+		return;
+	s_linuxClock.m_calibrated = true;
+
+#if defined(__x86_64__) || defined(__i386__)
+	if (!linuxTSCUsable())
+		return;
+
+	// calibrate against raw monotonic clock, not subject to NTP adjustments
+	struct timespec wait = { 0, 50 * 1000000 };
+	uint64_t ns1	= linuxClockNs(CLOCK_MONOTONIC_RAW);
+	uint64_t tsc1	= __rdtsc();
+	nanosleep(&wait, 0);
+	uint64_t tsc2	= __rdtsc();
+	uint64_t ns2	= linuxClockNs(CLOCK_MONOTONIC_RAW);
+
+	if ((tsc2 > tsc1) && (ns2 > ns1))
 	{
-		return m_stringIndexMap[_str];
+		s_linuxClock.m_frequency	= (uint64_t)(double(tsc2 - tsc1) * 1000000000.0 / double(ns2 - ns1));
+		s_linuxClock.m_source		= RPROF_CLOCK_TSC;
 	}
-};
+#endif
+}
+#endif // RPROF_PLATFORM_LINUX
 
 /*--------------------------------------------------------------------------
  * API functions
@@ -110,6 +2031,9 @@ extern "C" {
 
 	void rprofInit()
 	{
+#if RPROF_PLATFORM_LINUX
+		linuxClockCalibrate();
+#endif
 		g_context = new rprof::ProfilerContext();
 	}
 
@@ -153,10 +2077,17 @@ extern "C" {
 		return 0;
 	}
 
+	uintptr_t rprofBeginScopeDesc(ProfilerScopeDesc* _desc)
+	{
+		if (g_context)
+			return (uintptr_t)g_context->beginScope(_desc);
+		return 0;
+	}
+
 	void rprofEndScope(uintptr_t _scopeHandle)
 	{
 		if (g_context)
-			g_context->endScope((ProfilerScope*)_scopeHandle);
+			g_context->endScope((rprof::ProfilerOpenScope*)_scopeHandle);
 	}
 
 	int rprofIsPaused()
@@ -181,283 +2112,389 @@ extern "C" {
 			return 0;
 
 		g_context->getFrameData(_data);
+		return 1;
+	}
 
-		// clamp scopes crossing frame boundary
-		const uint32_t numScopes = _data->m_numScopes;
-		for (uint32_t i=0; i<numScopes; ++i)
-		{
-			ProfilerScope& cs = _data->m_scopes[i];
+	uint32_t rprofGetFrameCount()
+	{
+		return g_context ? g_context->getFrameCount() : 0;
+	}
 
-			if (cs.m_start == cs.m_end)
-			{
-				cs.m_end = _data->m_endtime;
-				if (cs.m_start < _data->m_startTime)
-					cs.m_start = _data->m_startTime;
-			}
-		}
+	int rprofGetFrameAt(uint32_t _index, ProfilerFrame* _data)
+	{
+		return g_context && g_context->getFrameDataAt(_index, _data) ? 1 : 0;
+	}
 
-		return 1;
+	int rprofStartRecording(const char* _path, int _compression, int _dictionary)
+	{
+		return g_context && g_context->startRecording(_path, _compression, _dictionary != 0) ? 1 : 0;
+	}
+
+	void rprofStopRecording()
+	{
+		if (g_context)
+			g_context->stopRecording();
+	}
+
+	void rprofGetRecordingStats(uint32_t* _numWritten, uint32_t* _numDropped)
+	{
+		if (_numWritten)
+			*_numWritten = 0;
+		if (_numDropped)
+			*_numDropped = 0;
+
+		if (g_context)
+			g_context->getRecordingStats(_numWritten, _numDropped);
+	}
+
+	void rprofGetDroppedScopes(uint32_t* _numNoThread, uint32_t* _numNoCallsite, uint32_t* _numFull)
+	{
+		if (_numNoThread)
+			*_numNoThread = 0;
+		if (_numNoCallsite)
+			*_numNoCallsite = 0;
+		if (_numFull)
+			*_numFull = 0;
+
+		if (g_context)
+			g_context->getDroppedScopes(_numNoThread, _numNoCallsite, _numFull);
+	}
+
+	size_t rprofSaveBound(ProfilerFrame* _data, int _compression)
+	{
+		SaveBounds bounds;
+		getSaveBounds(_data, true, getCompression(_compression), false, bounds);
+		return bounds.m_outputSize + bounds.m_scratchSize + sizeof(uint64_t);
+	}
+
+	int rprofSave(ProfilerFrame* _data, void* _buffer, size_t _bufferSize, int _compression)
+	{
+		return rprof::saveFrame(_data, _buffer, _bufferSize, 0, _compression, 0);
+	}
+
+	void rprofLoad(ProfilerFrame* _data, void* _buffer, size_t _bufferSize)
+	{
+		ProfilerFrameArena scratch;
+		loadFrame(_data, _buffer, _bufferSize, 0, scratch, false);
+	}
+
+	ProfilerFrameArena* rprofCreateFrameArena()
+	{
+		return new ProfilerFrameArena();
+	}
+
+	void rprofDestroyFrameArena(ProfilerFrameArena* _arena)
+	{
+		delete _arena;
 	}
 
-	int rprofSave(ProfilerFrame* _data, void* _buffer, size_t _bufferSize)
+	void rprofLoadToArena(ProfilerFrame* _data, void* _buffer, size_t _bufferSize, ProfilerFrameArena* _arena)
+	{
+		loadFrame(_data, _buffer, _bufferSize, 0, *_arena, true);
+	}
+
+	void rprofLoadTimeOnly(float* _time, void* _buffer, size_t _bufferSize)
 	{
-		// fill string data
-		StringStore strStore;
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
+		std::vector<uint8_t>	raw;
+		rprof::FrameHeader		header;
+
+		*_time = 0.0f;
+
+		ProfilerFrameSummary summary;
+		if (readFrameSummary(_buffer, _bufferSize, &summary))
 		{
-			ProfilerScope& scope = _data->m_scopes[i];
-			strStore.addString(scope.m_name);
-			strStore.addString(scope.m_file);
+			*_time = rprofClock2ms(summary.m_endTime - summary.m_startTime, summary.m_CPUFrequency);
+			return;
 		}
-		for (uint32_t i=0; i<_data->m_numThreads; ++i)
+
+		if (decompressFrame(_buffer, _bufferSize, raw, header) < (int)(3 * sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t)))
+			return;
+
+		uint64_t startTime;
+		uint64_t endtime, prevFrameTime;
+		uint32_t platformID;
+		uint64_t frequency;
+
+		uint8_t* buffer = &raw[0];
+		readVar(buffer, startTime);
+		readVar(buffer, endtime);
+		readVar(buffer, prevFrameTime);	// dummy
+		readVar(buffer, platformID);		// dummy
+		readVar(buffer, frequency);
+		*_time = rprofClock2ms(endtime - startTime, frequency);
+	}
+
+	int rprofLoadSummary(ProfilerFrameSummary* _summary, const void* _buffer, size_t _bufferSize)
+	{
+		return readFrameSummary(_buffer, _bufferSize, _summary) ? 1 : 0;
+	}
+
+	void rprofRelease(ProfilerFrame* _data)
+	{
+		// single block starting with scopes, see loadFrame
+		delete[] (uint64_t*)_data->m_scopes;
+		_data->m_scopes			= 0;
+		_data->m_scopesStats	= 0;
+		_data->m_scopeStatsInfo	= 0;
+		_data->m_threads		= 0;
+	}
+
+	ProfilerCapture* rprofOpenCapture(const char* _path)
+	{
+		using namespace rprof;
+
+		ProfilerCapture* capture = new ProfilerCapture();
+		capture->m_index			= 0;
+		capture->m_numFrames		= 0;
+		capture->m_clockFrequency	= 0;
+		capture->m_id				= ++s_captureID;
+
+		if (!capture->m_file.open(_path))
 		{
-			strStore.addString(_data->m_threads[i].m_name);
+			delete capture;
+			return 0;
 		}
 
-		// calc data size, overestimate to be safe
-		uint32_t maxTotalSize =	_data->m_numScopes  * sizeof(ProfilerScope)  +
-								_data->m_numThreads * sizeof(ProfilerThread) +
-								sizeof(ProfilerFrame) +
-								strStore.m_totalSize;
-
-		uint8_t* buffer = new uint8_t[maxTotalSize];
-		uint8_t* bufPtr = buffer;
+		const uint8_t*	data		= capture->m_file.getData();
+		uint64_t		fileSize	= capture->m_file.getSize();
 
-		writeVar(buffer, _data->m_startTime);
-		writeVar(buffer, _data->m_endtime);
-		writeVar(buffer, _data->m_prevFrameTime);
-		writeVar(buffer, _data->m_platformID);
-		writeVar(buffer, rprofGetClockFrequency());
+		MultiFrameHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(&header, data, fileSize < sizeof(header) ? (size_t)fileSize : sizeof(header));
 
-		// write scopes
-		writeVar(buffer, _data->m_numScopes);
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
+		if (header.m_signature == s_multiFrameSignatureLegacy)
+			scanFrameIndex(capture, sizeof(uint32_t));
+		else
+		if (header.m_signature == s_multiFrameSignature)
 		{
-			ProfilerScope& scope = _data->m_scopes[i];
-			writeVar(buffer, scope.m_start);
-			writeVar(buffer, scope.m_end);
-			writeVar(buffer, scope.m_threadID);
-			writeVar(buffer, strStore.getString(scope.m_name));
-			writeVar(buffer, strStore.getString(scope.m_file));
-			writeVar(buffer, scope.m_line);
-			writeVar(buffer, scope.m_level);
+			if ((header.m_version == s_multiFrameVersion) && !readFrameIndexTable(capture))
+				scanFrameIndex(capture, sizeof(header));
+		}
+		else
+		if (fileSize <= 0xffffffff)
+		{
+			// single frame capture
+			capture->m_indexStorage.resize(1);
+			ProfilerFrameIndex& entry = capture->m_indexStorage[0];
+			entry.m_offset	= 0;
+			entry.m_size	= (uint32_t)fileSize;
+
+			std::vector<uint8_t> buffer;
+			if (readFrameInfo(data, entry.m_size, entry, capture->m_clockFrequency, buffer))
+			{
+				capture->m_index		= &entry;
+				capture->m_numFrames	= 1;
+			}
 		}
 
-		// write thread info
-		writeVar(buffer, _data->m_numThreads);
-		for (uint32_t i=0; i<_data->m_numThreads; ++i)
+		if (!capture->m_numFrames)
 		{
-			ProfilerThread& t = _data->m_threads[i];
-			writeVar(buffer, t.m_threadID);
-			writeVar(buffer, strStore.getString(t.m_name));
+			delete capture;
+			return 0;
 		}
+		return capture;
+	}
 
-		// write string data
-		uint32_t numStrings = (uint32_t)strStore.m_strings.size();
-		writeVar(buffer, numStrings);
+	void rprofCloseCapture(ProfilerCapture* _capture)
+	{
+		delete _capture;
+	}
 
-		for (uint32_t i=0; i<strStore.m_strings.size(); ++i)
-			writeStr(buffer, strStore.m_strings[i].c_str());
+	uint32_t rprofGetCaptureFrameCount(ProfilerCapture* _capture)
+	{
+		return _capture->m_numFrames;
+	}
 
-		int compSize = LZ4_compress_default((const char*)bufPtr, (char*)_buffer, (int)(buffer - bufPtr), (int)_bufferSize);
-		delete[] bufPtr;
-		return compSize;
+	const ProfilerFrameIndex* rprofGetCaptureFrameIndex(ProfilerCapture* _capture)
+	{
+		return _capture->m_index;
 	}
 
-	void rprofLoad(ProfilerFrame* _data, void* _buffer, size_t _bufferSize)
+	uint64_t rprofGetCaptureClockFrequency(ProfilerCapture* _capture)
 	{
-		size_t		bufferSize	= _bufferSize;
-		uint8_t*	buffer		= 0;
-		uint8_t*	bufferPtr;
+		return _capture->m_clockFrequency;
+	}
 
-		int decomp = -1;
-		do 
-		{
-			delete[] buffer;
-			bufferSize *= 2;
-			buffer = new uint8_t[bufferSize];
-			decomp = LZ4_decompress_safe((const char*)_buffer, (char*)buffer, (int)_bufferSize, (int)bufferSize);
+	const void* rprofGetCaptureFrameData(ProfilerCapture* _capture, uint32_t _frame, size_t* _size)
+	{
+		if (_frame >= _capture->m_numFrames)
+			return 0;
 
-		} while ((decomp < 0) && (bufferSize <= RPROF_LZ4_BUFFER_MAX_SIZE));
+		const ProfilerFrameIndex& entry = _capture->m_index[_frame];
+		if (_size)
+			*_size = entry.m_size;
+		return _capture->m_file.getData() + entry.m_offset;
+	}
 
-		bufferPtr = buffer;
+	int rprofLoadCaptureFrame(ProfilerCapture* _capture, uint32_t _frame, ProfilerFrame* _data)
+	{
+		size_t size;
+		const void* data = rprofGetCaptureFrameData(_capture, _frame, &size);
+		FrameDependencies deps;
+		if (!data || !getCaptureFrameDependencies(_capture, _capture->m_arena, _frame, deps))
+			return 0;
 
-		uint32_t strIdx;
+		loadFrame(_data, data, size, &deps, _capture->m_arena, false);
+		return 1;
+	}
 
-		readVar(buffer, _data->m_startTime);
-		readVar(buffer, _data->m_endtime);
-		readVar(buffer, _data->m_prevFrameTime);
-		readVar(buffer, _data->m_platformID);
-		readVar(buffer, _data->m_CPUFrequency);
+	int rprofLoadCaptureFrameToArena(ProfilerCapture* _capture, uint32_t _frame, ProfilerFrame* _data, ProfilerFrameArena* _arena)
+	{
+		size_t size;
+		const void* data = rprofGetCaptureFrameData(_capture, _frame, &size);
+		FrameDependencies deps;
+		if (!data || !getCaptureFrameDependencies(_capture, *_arena, _frame, deps))
+			return 0;
 
-		// read scopes
-		readVar(buffer, _data->m_numScopes);
+		loadFrame(_data, data, size, &deps, *_arena, true);
+		return 1;
+	}
 
-		_data->m_scopes			= new ProfilerScope[_data->m_numScopes * 2]; // extra space for viewer - m_scopesStats
-		_data->m_scopesStats	= &_data->m_scopes[_data->m_numScopes];
-		_data->m_scopeStatsInfo	= new ProfilerScopeStats[_data->m_numScopes * 2];
+	uint32_t rprofProcessCaptureFrames(ProfilerCapture* _capture, ProfilerFrameCallback _callback, void* _userData, uint32_t _numWorkers, uint32_t _firstFrame, uint32_t _numFrames)
+	{
+		uint32_t numFrames	= _capture->m_numFrames;
+		uint32_t firstFrame	= std::min(_firstFrame, numFrames);
+		uint32_t endFrame	= _numFrames < numFrames - firstFrame ? firstFrame + _numFrames : numFrames;
 
-		for (uint32_t i=0; i<_data->m_numScopes*2; ++i)
-			_data->m_scopes[i].m_stats = &_data->m_scopeStatsInfo[i];
+		uint32_t firstGroup	= firstFrame / RPROF_SAVE_DICT_INTERVAL;
+		uint32_t endGroup	= (endFrame + RPROF_SAVE_DICT_INTERVAL - 1) / RPROF_SAVE_DICT_INTERVAL;
+		uint32_t numGroups	= endGroup - firstGroup;
 
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
-		{
-			ProfilerScope& scope = _data->m_scopes[i];
-			readVar(buffer, scope.m_start);
-			readVar(buffer, scope.m_end);
-			readVar(buffer, scope.m_threadID);
-			readVar(buffer, strIdx);
-			scope.m_name = (const char*)(uintptr_t)strIdx;
-			readVar(buffer, strIdx);
-			scope.m_file = (const char*)(uintptr_t)strIdx;
-			readVar(buffer, scope.m_line);
-			readVar(buffer, scope.m_level);
+#if RPROF_THREADS_SUPPORTED
+		_numWorkers = std::max(std::min(_numWorkers, numGroups), 1u);
+#else
+		_numWorkers = 1;
+#endif
 
-			scope.m_stats->m_inclusiveTime	= scope.m_end - scope.m_start;
-			scope.m_stats->m_exclusiveTime	= scope.m_stats->m_inclusiveTime;
-			scope.m_stats->m_occurences		= 0;
-		}
+		FrameWorkers workers;
+		workers.m_capture		= _capture;
+		workers.m_callback		= _callback;
+		workers.m_userData		= _userData;
+		workers.m_workers		= new FrameWorker[_numWorkers];
+		workers.m_numWorkers	= _numWorkers;
+		workers.m_firstFrame	= firstFrame;
+		workers.m_endFrame		= endFrame;
 
-		// read thread info
-		readVar(buffer, _data->m_numThreads);
-		_data->m_threads = new ProfilerThread[_data->m_numThreads];
-		for (uint32_t i=0; i<_data->m_numThreads; ++i)
+		for (uint32_t i=0; i<_numWorkers; ++i)
 		{
-			ProfilerThread& t = _data->m_threads[i];
-			readVar(buffer, t.m_threadID);
-			readVar(buffer, strIdx);
-			t.m_name = (const char*)(uintptr_t)strIdx;
+			FrameWorker& worker = workers.m_workers[i];
+			worker.m_groups.store(packFrameGroups(	firstGroup + (uint32_t)((uint64_t)numGroups * i / _numWorkers),
+													firstGroup + (uint32_t)((uint64_t)numGroups * (i + 1) / _numWorkers)));
+			worker.m_workers		= &workers;
+			worker.m_index			= i;
+			worker.m_numProcessed	= 0;
 		}
 
-		// read string data
-		uint32_t numStrings;
-		readVar(buffer, numStrings);
+#if RPROF_THREADS_SUPPORTED
+		// worker that failed to start leaves its groups to others
+		for (uint32_t i=1; i<_numWorkers; ++i)
+			workers.m_workers[i].m_thread.start(processFrames, &workers.m_workers[i]);
+#endif
 
-		const char** strings = new const char*[numStrings];
-		for (uint32_t i=0; i<numStrings; ++i)
-			strings[i] = readString(buffer);
+		processFrames(&workers.m_workers[0]);
 
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
+		uint32_t numProcessed = 0;
+		for (uint32_t i=0; i<_numWorkers; ++i)
 		{
-			ProfilerScope& scope = _data->m_scopes[i];
-			uintptr_t idx = (uintptr_t)scope.m_name;
-			scope.m_name = duplicateString((idx < numStrings) ? strings[(uint32_t)idx] : "");
-
-			idx = (uintptr_t)scope.m_file;
-			scope.m_file = duplicateString((idx < numStrings) ? strings[(uint32_t)idx] : "");
+#if RPROF_THREADS_SUPPORTED
+			workers.m_workers[i].m_thread.join();
+#endif
+			numProcessed += workers.m_workers[i].m_numProcessed;
 		}
 
-		for (uint32_t i=0; i<_data->m_numThreads; ++i)
-		{
-			ProfilerThread& t = _data->m_threads[i];
-			uintptr_t idx = (uintptr_t)t.m_name;
-			t.m_name = duplicateString((idx < numStrings) ? strings[(uint32_t)idx] : "");
-		}
+		delete[] workers.m_workers;
+		return numProcessed;
+	}
+
+	ProfilerCallTree* rprofCreateCallTree()
+	{
+		ProfilerCallTree* tree = new ProfilerCallTree();
+		tree->m_frequency = 0;
+		tree->m_numFrames = 0;
+		return tree;
+	}
 
-		for (uint32_t i=0; i<numStrings; ++i)
-			delete[] strings[i];
+	void rprofDestroyCallTree(ProfilerCallTree* _tree)
+	{
+		delete _tree;
+	}
 
-		delete[] strings;
-		delete[] bufferPtr;
+	void rprofClearCallTree(ProfilerCallTree* _tree)
+	{
+		_tree->m_paths.clear();
+		_tree->m_pathIndices.clear();
+		_tree->m_frequency = 0;
+		_tree->m_numFrames = 0;
+	}
 
-		// process frame data
+	void rprofAddToCallTree(ProfilerCallTree* _tree, ProfilerFrame* _data, uint32_t* _scopePaths)
+	{
+		_tree->m_numFrames++;
+		if (!_data->m_numScopes)
+			return;
 
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
-		for (uint32_t j=0; j<_data->m_numScopes; ++j)
-		{
-			ProfilerScope& scopeI = _data->m_scopes[i];
-			ProfilerScope& scopeJ = _data->m_scopes[j];
+		addToCallTree(*_tree, _data);
+		if (_scopePaths)
+			memcpy(_scopePaths, &_tree->m_scopePaths[0], sizeof(uint32_t) * _data->m_numScopes);
+	}
 
-			if ((scopeJ.m_start > scopeI.m_start) && (scopeJ.m_end < scopeI.m_end) &&
-				(scopeJ.m_level == scopeI.m_level + 1) && (scopeJ.m_threadID == scopeI.m_threadID))
-				scopeI.m_stats->m_exclusiveTime -= scopeJ.m_stats->m_inclusiveTime;
-		}
+	uint32_t rprofGetCallPaths(ProfilerCallTree* _tree, const ProfilerCallPath** _paths, uint64_t* _frequency)
+	{
+		*_paths = _tree->m_paths.empty() ? 0 : &_tree->m_paths[0];
+		if (_frequency)
+			*_frequency = _tree->m_frequency;
+		return (uint32_t)_tree->m_paths.size();
+	}
 
-		_data->m_numScopesStats	= 0;
+	uint32_t rprofGetCallTreeFrameCount(ProfilerCallTree* _tree)
+	{
+		return _tree->m_numFrames;
+	}
 
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
-		{
-			ProfilerScope& scopeI = _data->m_scopes[i];
+	uint32_t rprofDiffCallTrees(ProfilerCallTree* _base, ProfilerCallTree* _tree, uint32_t _mode, ProfilerDiffScope** _scopes)
+	{
+		ProfilerCallTree* trees[2] = { _base, _tree };
+		std::vector<ProfilerDiffScope> scopes;
+		diffCallTrees(trees, _mode, scopes);
 
-			scopeI.m_stats->m_inclusiveTimeTotal = scopeI.m_stats->m_inclusiveTime;
-			scopeI.m_stats->m_exclusiveTimeTotal = scopeI.m_stats->m_exclusiveTime;
+		*_scopes = 0;
+		if (scopes.empty())
+			return 0;
 
-			int foundIndex = -1;
-			for (uint32_t j=0; j<_data->m_numScopesStats; ++j)
-			{
-				ProfilerScope& scopeJ = _data->m_scopesStats[j];
-				if (strcmp(scopeI.m_name, scopeJ.m_name) == 0)
-				{
-					foundIndex = j;
-					break;
-				}
-			}
+		*_scopes = new ProfilerDiffScope[scopes.size()];
+		memcpy(*_scopes, &scopes[0], sizeof(ProfilerDiffScope) * scopes.size());
+		return (uint32_t)scopes.size();
+	}
 
-			if (foundIndex == -1)
-			{
-				int index = _data->m_numScopesStats++;
-				ProfilerScope& scope = _data->m_scopesStats[index];
-				scope						= scopeI;
-				scope.m_stats->m_occurences	= 1;
-			}
-			else
-			{
-				ProfilerScope& scope = _data->m_scopesStats[foundIndex];
-				scope.m_stats->m_inclusiveTimeTotal += scopeI.m_stats->m_inclusiveTime;
-				scope.m_stats->m_exclusiveTimeTotal += scopeI.m_stats->m_exclusiveTime;
-				scope.m_stats->m_occurences++;
-			}
-		}
+	void rprofReleaseDiff(ProfilerDiffScope* _scopes)
+	{
+		delete[] _scopes;
 	}
 
-	void rprofLoadTimeOnly(float* _time, void* _buffer, size_t _bufferSize)
+	uint32_t rprofLoadFrameIndex(const char* _path, ProfilerFrameIndex** _index, uint64_t* _clockFrequency)
 	{
-		size_t		bufferSize = _bufferSize;
-		uint8_t*	buffer = 0;
+		*_index = 0;
+		if (_clockFrequency)
+			*_clockFrequency = 0;
 
-		int decomp = -1;
-		do
-		{
-			delete[] buffer;
-			bufferSize *= 2;
-			buffer = new uint8_t[bufferSize];
-			decomp = LZ4_decompress_safe((const char*)_buffer, (char*)buffer, (int)_bufferSize, (int)bufferSize);
+		ProfilerCapture* capture = rprofOpenCapture(_path);
+		if (!capture)
+			return 0;
 
-		} while ((decomp < 0) && (bufferSize <= RPROF_LZ4_BUFFER_MAX_SIZE));
+		uint32_t numFrames = capture->m_numFrames;
+		*_index = new ProfilerFrameIndex[numFrames];
+		memcpy(*_index, capture->m_index, sizeof(ProfilerFrameIndex) * numFrames);
 
-		uint64_t startTime;
-		uint64_t endtime, prevFrameTime;
-		uint32_t platformID;
-		uint64_t frequency;
+		if (_clockFrequency)
+			*_clockFrequency = capture->m_clockFrequency;
 
-		uint8_t* bufPtr = buffer;
-		readVar(buffer, startTime);
-		readVar(buffer, endtime);
-		readVar(buffer, prevFrameTime);	// dummy
-		readVar(buffer, platformID);		// dummy
-		readVar(buffer, frequency);
-		*_time = rprofClock2ms(endtime - startTime, frequency);
-		delete[] bufPtr;
+		rprofCloseCapture(capture);
+		return numFrames;
 	}
 
-	void rprofRelease(ProfilerFrame* _data)
+	void rprofReleaseFrameIndex(ProfilerFrameIndex* _index)
 	{
-		for (uint32_t i=0; i<_data->m_numScopes; ++i)
-		{
-			ProfilerScope& scope = _data->m_scopes[i];
-			delete[] scope.m_name;
-			delete[] scope.m_file;
-		}
-
-		for (uint32_t i=0; i<_data->m_numThreads; ++i)
-		{
-			ProfilerThread& t = _data->m_threads[i];
-			delete[] t.m_name;
-		}
-
-		delete[] _data->m_scopes;
-		delete[] _data->m_threads;
-		delete[] _data->m_scopeStatsInfo;
+		delete[] _index;
 	}
 
 	uint64_t rprofGetClock()
@@ -482,6 +2519,12 @@ extern "C" {
 		int64_t q = (int64_t)(emscripten_get_now() * 1000.0);
 #elif RPROF_PLATFORM_SWITCH
 		int64_t q = nn::os::GetSystemTick().GetInt64Value();
+#elif RPROF_PLATFORM_LINUX
+	#if defined(__x86_64__) || defined(__i386__)
+		if (s_linuxClock.m_source == RPROF_CLOCK_TSC)
+			return __rdtsc();
+	#endif
+		uint64_t q = linuxClockNs(CLOCK_MONOTONIC);
 #else
 		struct timeval now;
 		gettimeofday(&now, 0);
@@ -527,11 +2570,38 @@ extern "C" {
 		return sceKernelGetTscFrequency();
 #elif RPROF_PLATFORM_SWITCH
 		return nn::os::GetSystemTickFrequency();
+#elif RPROF_PLATFORM_LINUX
+		return s_linuxClock.m_frequency;
 #else
 		return 1000000;
 #endif
 	}
 
+	uint8_t rprofGetClockSource()
+	{
+#if   RPROF_PLATFORM_WINDOWS
+	#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+		return RPROF_CLOCK_TSC;
+	#else
+		return RPROF_CLOCK_QPC;
+	#endif
+#elif RPROF_PLATFORM_XBOXONE
+		return RPROF_CLOCK_QPC;
+#elif RPROF_PLATFORM_PS4
+		return RPROF_CLOCK_TSC;
+#elif RPROF_PLATFORM_ANDROID
+		return RPROF_CLOCK_CLOCK;
+#elif RPROF_PLATFORM_EMSCRIPTEN
+		return RPROF_CLOCK_EMSCRIPTEN;
+#elif RPROF_PLATFORM_SWITCH
+		return RPROF_CLOCK_SYSTEM_TICK;
+#elif RPROF_PLATFORM_LINUX
+		return s_linuxClock.m_source;
+#else
+		return RPROF_CLOCK_GETTIMEOFDAY;
+#endif
+	}
+
 	float rprofClock2ms(uint64_t _clock, uint64_t _frequency)
 	{
 		return _frequency ? (float(_clock) / float(_frequency)) * 1000.0f : 0.0f;
@@ -542,4 +2612,9 @@ extern "C" {
 		return getPlatformName(_platformID);
 	}
 
+	const char* rprofGetClockSourceName(uint8_t _clockSource)
+	{
+		return getClockSourceName(_clockSource);
+	}
+
 } // extern "C"
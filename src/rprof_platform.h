@@ -99,6 +99,11 @@
 #elif RPROF_PLATFORM_POSIX
        #if RPROF_PLATFORM_LINUX
                #include <sys/syscall.h>
+               #include <time.h>
+               #if defined(__x86_64__) || defined(__i386__)
+                       #include <cpuid.h>
+                       #include <x86intrin.h>
+               #endif
        #endif
 	#include <unistd.h>	 // syscall
 	#include <pthread.h>
@@ -107,6 +112,20 @@
 	#error "Unsupported platform!"
 #endif
 
+#include <stdio.h>
+
+/*--------------------------------------------------------------------------
+ * Clock sources
+ *------------------------------------------------------------------------*/
+#define RPROF_CLOCK_UNKNOWN			0
+#define RPROF_CLOCK_TSC				1
+#define RPROF_CLOCK_QPC				2
+#define RPROF_CLOCK_MONOTONIC		3
+#define RPROF_CLOCK_GETTIMEOFDAY	4
+#define RPROF_CLOCK_CLOCK			5
+#define RPROF_CLOCK_EMSCRIPTEN		6
+#define RPROF_CLOCK_SYSTEM_TICK		7
+
 /*--------------------------------------------------------------------------*/
 static inline uint64_t getThreadID()
 {
@@ -176,4 +195,44 @@ static inline const char* getPlatformName(uint8_t _platformID)
 	};
 }
 
+/*--------------------------------------------------------------------------*/
+static inline const char* getClockSourceName(uint8_t _clockSource)
+{
+	switch (_clockSource)
+	{
+	case RPROF_CLOCK_TSC:			return "TSC";
+	case RPROF_CLOCK_QPC:			return "QueryPerformanceCounter";
+	case RPROF_CLOCK_MONOTONIC:		return "clock_gettime";
+	case RPROF_CLOCK_GETTIMEOFDAY:	return "gettimeofday";
+	case RPROF_CLOCK_CLOCK:			return "clock";
+	case RPROF_CLOCK_EMSCRIPTEN:	return "emscripten_get_now";
+	case RPROF_CLOCK_SYSTEM_TICK:	return "System tick";
+	default:						return "Unknown clock";
+	};
+}
+
+/*--------------------------------------------------------------------------*/
+static inline int fileSeek(FILE* _file, int64_t _offset, int _origin)
+{
+#if RPROF_PLATFORM_WINDOWS || RPROF_PLATFORM_XBOXONE
+	return _fseeki64(_file, _offset, _origin);
+#elif RPROF_PLATFORM_POSIX
+	return fseeko(_file, (off_t)_offset, _origin);
+#else
+	return fseek(_file, (long)_offset, _origin);
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+static inline int64_t fileTell(FILE* _file)
+{
+#if RPROF_PLATFORM_WINDOWS || RPROF_PLATFORM_XBOXONE
+	return _ftelli64(_file);
+#elif RPROF_PLATFORM_POSIX
+	return (int64_t)ftello(_file);
+#else
+	return (int64_t)ftell(_file);
+#endif
+}
+
 #endif // RPROF_PLATFORM_H
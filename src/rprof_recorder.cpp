@@ -0,0 +1,300 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "../inc/rprof.h"
+#include "rprof_config.h"
+#include "rprof_platform.h"
+#include "rprof_context.h"
+#include "rprof_recorder.h"
+#include "rprof_format.h"
+#include "rprof_strings.h"
+
+namespace rprof {
+
+	ProfilerRecorder::ProfilerRecorder(ProfilerContext* _context)
+		: m_context(_context)
+		, m_file(0)
+		, m_queueHead(0)
+		, m_queueCount(0)
+		, m_numWritten(0)
+		, m_numDropped(0)
+		, m_stop(true)
+		, m_fileOffset(0)
+		, m_writeFailed(false)
+		, m_scopes(0)
+		, m_threads(0)
+		, m_threadNames(0)
+		, m_strings(0)
+		, m_dict(0)
+		, m_buffer(0)
+		, m_compression(RPROF_COMPRESSION_DEFAULT)
+	{
+		for (uint32_t i=0; i<RPROF_RECORDING_QUEUE_SIZE; ++i)
+			m_queue[i] = 0;
+	}
+
+	ProfilerRecorder::~ProfilerRecorder()
+	{
+		stop();
+	}
+
+	bool ProfilerRecorder::start(const char* _path, int _compression, bool _dictionary)
+	{
+#if RPROF_THREADS_SUPPORTED
+		if (m_file)
+			return false;
+
+		m_file = fopen(_path, "wb");
+		if (!m_file)
+			return false;
+
+		MultiFrameHeader header;
+		header.m_signature	= s_multiFrameSignature;
+		header.m_version	= s_multiFrameVersion;
+		if (fwrite(&header, sizeof(header), 1, m_file) != 1)
+		{
+			fclose(m_file);
+			m_file = 0;
+			return false;
+		}
+
+		m_fileOffset	= sizeof(header);
+		m_writeFailed	= false;
+		m_index.clear();
+
+		for (uint32_t i=0; i<RPROF_RECORDING_QUEUE_SIZE; ++i)
+			m_queue[i] = new ProfilerCapturedFrame();
+
+		m_scopes		= new ProfilerScope[RPROF_SCOPES_MAX];
+		m_threads		= new ProfilerThread[RPROF_DRAW_THREADS_MAX];
+		m_threadNames	= new std::string[RPROF_DRAW_THREADS_MAX];
+		// scope names and files are owned by the context for its lifetime
+		m_strings		= new StringStore(true);
+		m_dict			= _dictionary ? new FrameDictionary() : 0;
+		m_buffer		= new uint8_t[RPROF_LZ4_BUFFER_MAX_SIZE];
+		m_compression	= _compression;
+
+		if (m_dict)
+			m_dict->m_size = 0;
+
+		{
+			ScopedMutexLocker lock(m_queueMutex);
+			m_queueHead		= 0;
+			m_queueCount	= 0;
+			m_numWritten	= 0;
+			m_numDropped	= 0;
+			m_stop			= false;
+		}
+
+		if (m_thread.start(threadFunc, this))
+			return true;
+
+		stop();
+		return false;
+#else
+		(void)_path;
+		(void)_compression;
+		(void)_dictionary;
+		return false;
+#endif
+	}
+
+	void ProfilerRecorder::stop()
+	{
+		if (!m_file)
+			return;
+
+		{
+			ScopedMutexLocker lock(m_queueMutex);
+			m_stop = true;
+		}
+
+		// writer thread flushes queued frames before exiting
+#if RPROF_THREADS_SUPPORTED
+		m_signal.signal();
+		m_thread.join();
+#endif
+
+		writeIndex();
+		fclose(m_file);
+		m_file = 0;
+
+		for (uint32_t i=0; i<RPROF_RECORDING_QUEUE_SIZE; ++i)
+		{
+			delete m_queue[i];
+			m_queue[i] = 0;
+		}
+
+		delete[] m_scopes;
+		delete[] m_threads;
+		delete[] m_threadNames;
+		delete m_strings;
+		delete m_dict;
+		delete[] m_buffer;
+		m_scopes		= 0;
+		m_threads		= 0;
+		m_threadNames	= 0;
+		m_strings		= 0;
+		m_dict			= 0;
+		m_buffer		= 0;
+	}
+
+	void ProfilerRecorder::push(const ProfilerCapturedFrame& _frame)
+	{
+		{
+			ScopedMutexLocker lock(m_queueMutex);
+			if (m_stop)
+				return;
+
+			if (m_queueCount == RPROF_RECORDING_QUEUE_SIZE)
+			{
+				++m_numDropped;
+				return;
+			}
+
+			// slot is not visible to writer thread until count is incremented
+			m_queue[(m_queueHead + m_queueCount) % RPROF_RECORDING_QUEUE_SIZE]->copyFrom(_frame);
+			++m_queueCount;
+		}
+
+#if RPROF_THREADS_SUPPORTED
+		m_signal.signal();
+#endif
+	}
+
+	void ProfilerRecorder::getStats(uint32_t* _numWritten, uint32_t* _numDropped)
+	{
+		ScopedMutexLocker lock(m_queueMutex);
+		if (_numWritten)
+			*_numWritten = m_numWritten;
+		if (_numDropped)
+			*_numDropped = m_numDropped;
+	}
+
+	void ProfilerRecorder::threadFunc(void* _recorder)
+	{
+		((ProfilerRecorder*)_recorder)->writeFrames();
+	}
+
+	void ProfilerRecorder::writeFrames()
+	{
+#if RPROF_THREADS_SUPPORTED
+		for (;;)
+		{
+			m_signal.wait();
+
+			for (;;)
+			{
+				ProfilerCapturedFrame* frame;
+				{
+					ScopedMutexLocker lock(m_queueMutex);
+					if (!m_queueCount)
+					{
+						if (m_stop)
+							return;
+						break;
+					}
+					frame = m_queue[m_queueHead];
+				}
+
+				// frame stays queued while being written so capturing thread
+				// can not reuse the slot
+				bool written = writeFrame(frame);
+
+				ScopedMutexLocker lock(m_queueMutex);
+				m_queueHead = (m_queueHead + 1) % RPROF_RECORDING_QUEUE_SIZE;
+				--m_queueCount;
+				if (written)
+					++m_numWritten;
+				else
+					++m_numDropped;
+			}
+		}
+#endif
+	}
+
+	bool ProfilerRecorder::writeFrame(const ProfilerCapturedFrame* _frame)
+	{
+		// file position is unknown after a failed write, nothing more can be appended
+		if (m_writeFailed)
+			return false;
+
+		ProfilerFrame data;
+		m_context->getFrameData(_frame, &data, m_scopes, m_threads, m_threadNames);
+
+		// dictionary chains are cut so that loading a frame does not need
+		// all frames before it
+		if (m_dict && (m_index.size() % RPROF_SAVE_DICT_INTERVAL == 0))
+			m_dict->m_size = 0;
+
+		int size = saveFrame(&data, m_buffer, RPROF_LZ4_BUFFER_MAX_SIZE, m_strings, m_compression, m_dict);
+		if (size <= 0)
+			return false;
+
+		uint32_t frameSize = (uint32_t)size;
+		if ((fwrite(&frameSize, sizeof(uint32_t), 1, m_file) != 1) ||
+			(fwrite(m_buffer, 1, frameSize, m_file) != frameSize))
+		{
+			m_writeFailed = true;
+			return false;
+		}
+
+		ProfilerFrameIndex entry;
+		entry.m_offset		= m_fileOffset + sizeof(uint32_t);
+		entry.m_startTime	= data.m_startTime;
+		entry.m_endTime		= data.m_endtime;
+		entry.m_size		= frameSize;
+		entry.m_numScopes	= data.m_numScopes;
+		entry.m_numThreads	= data.m_numThreads;
+		entry.m_reserved	= 0;
+		m_index.push_back(entry);
+
+		m_fileOffset = entry.m_offset + frameSize;
+		return true;
+	}
+
+	void ProfilerRecorder::writeIndex()
+	{
+		if (m_writeFailed)
+			return;
+
+		// index is aligned so that mapped files can use it in place
+		static const uint8_t padding[sizeof(uint64_t)] = { 0 };
+		uint32_t paddingSize = (uint32_t)((sizeof(uint64_t) - m_fileOffset % sizeof(uint64_t)) % sizeof(uint64_t));
+		fwrite(padding, 1, paddingSize, m_file);
+
+		MultiFrameTrailer trailer;
+		trailer.m_indexOffset		= m_fileOffset + paddingSize;
+		trailer.m_clockFrequency	= rprofGetClockFrequency();
+		trailer.m_numFrames			= (uint32_t)m_index.size();
+		trailer.m_version			= s_multiFrameVersion;
+		trailer.m_reserved			= 0;
+		trailer.m_signature			= s_multiFrameSignature;
+
+		if (trailer.m_numFrames)
+			fwrite(&m_index[0], sizeof(ProfilerFrameIndex), trailer.m_numFrames, m_file);
+		writeStrings(trailer.m_indexOffset + (uint64_t)trailer.m_numFrames * sizeof(ProfilerFrameIndex));
+		fwrite(&trailer, sizeof(trailer), 1, m_file);
+
+		std::vector<ProfilerFrameIndex>().swap(m_index);
+	}
+
+	void ProfilerRecorder::writeStrings(uint64_t _offset)
+	{
+		MultiFrameStrings strings;
+		strings.m_offset		= _offset;
+		strings.m_numStrings	= m_strings->getNumStrings();
+		strings.m_size			= 0;
+
+		for (uint32_t i=0; i<strings.m_numStrings; ++i)
+		{
+			const std::string& str = m_strings->m_strings[i];
+			fwrite(str.c_str(), 1, str.size() + 1, m_file);
+			strings.m_size += (uint32_t)str.size() + 1;
+		}
+		fwrite(&strings, sizeof(strings), 1, m_file);
+	}
+
+} // namespace rprof
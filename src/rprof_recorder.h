@@ -0,0 +1,77 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef RPROF_RECORDER_H
+#define RPROF_RECORDER_H
+
+#include "../inc/rprof.h"
+#include "rprof_config.h"
+#include "rprof_mutex.h"
+#include "rprof_thread.h"
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+namespace rprof {
+
+	struct ProfilerCapturedFrame;
+	struct StringStore;
+	struct FrameDictionary;
+	class ProfilerContext;
+
+	// Streams captured frames to a multi frame capture file. Frames are copied
+	// to a bounded queue on the capturing thread, expanded, compressed and
+	// written out on a dedicated writer thread.
+	class ProfilerRecorder
+	{
+		ProfilerContext*		m_context;
+		FILE*					m_file;
+
+		Mutex					m_queueMutex;
+		ProfilerCapturedFrame*	m_queue[RPROF_RECORDING_QUEUE_SIZE];
+		uint32_t				m_queueHead;
+		uint32_t				m_queueCount;
+		uint32_t				m_numWritten;
+		uint32_t				m_numDropped;
+		bool					m_stop;
+
+#if RPROF_THREADS_SUPPORTED
+		Thread					m_thread;
+		Event					m_signal;
+#endif
+
+		// owned by writer thread
+		uint64_t				m_fileOffset;
+		bool					m_writeFailed;
+		std::vector<ProfilerFrameIndex>	m_index;
+		ProfilerScope*			m_scopes;
+		ProfilerThread*			m_threads;
+		std::string*			m_threadNames;
+		StringStore*			m_strings;
+		FrameDictionary*		m_dict;
+		uint8_t*				m_buffer;
+		int						m_compression;
+
+	public:
+		ProfilerRecorder(ProfilerContext* _context);
+		~ProfilerRecorder();
+
+		bool					start(const char* _path, int _compression, bool _dictionary);
+		void					stop();
+		void					push(const ProfilerCapturedFrame& _frame);
+		void					getStats(uint32_t* _numWritten, uint32_t* _numDropped);
+
+	private:
+		static void				threadFunc(void* _recorder);
+		void					writeFrames();
+		bool					writeFrame(const ProfilerCapturedFrame* _frame);
+		void					writeIndex();
+		void					writeStrings(uint64_t _offset);
+	};
+
+} // namespace rprof
+
+#endif // RPROF_RECORDER_H
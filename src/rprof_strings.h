@@ -0,0 +1,93 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef RPROF_STRINGS_H
+#define RPROF_STRINGS_H
+
+#include "rprof_platform.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace rprof {
+
+	// Strings referenced by saved frames, frames store string indices.
+	// A store kept across frames (multi frame recording) is append only, each
+	// frame saves just the strings added since the previous frame.
+	struct StringStore
+	{
+		typedef std::unordered_map<std::string, uint32_t>	StringToIndexType;
+		typedef std::unordered_map<const char*, uint32_t>	PointerToIndexType;
+
+		uint32_t					m_totalSize;
+		StringToIndexType			m_stringIndexMap;
+		PointerToIndexType			m_pointerIndexMap;
+		std::vector<std::string>	m_strings;
+		bool						m_cachePointers;
+
+		// _cachePointers - strings passed to addStaticString do not change
+		// while the store is used, they are looked up by address
+		StringStore(bool _cachePointers = false)
+			: m_totalSize(0)
+			, m_cachePointers(_cachePointers)
+		{
+		}
+
+		uint32_t addString(const char* _str)
+		{
+			std::pair<StringToIndexType::iterator, bool> it = m_stringIndexMap.insert(std::make_pair(std::string(_str), (uint32_t)m_strings.size()));
+			if (it.second)
+			{
+				m_totalSize += 4 + (uint32_t)strlen(_str);	// see writeStr for details
+				m_strings.push_back(_str);
+			}
+			return it.first->second;
+		}
+
+		uint32_t addStaticString(const char* _str)
+		{
+			if (!m_cachePointers)
+				return addString(_str);
+
+			PointerToIndexType::iterator it = m_pointerIndexMap.find(_str);
+			if (it != m_pointerIndexMap.end())
+				return it->second;
+
+			uint32_t index = addString(_str);
+			m_pointerIndexMap[_str] = index;
+			return index;
+		}
+
+		inline uint32_t getNumStrings() const { return (uint32_t)m_strings.size(); }
+
+		// Removes strings added after first _numStrings, used when a frame
+		// that added them could not be saved
+		void truncate(uint32_t _numStrings)
+		{
+			if (_numStrings >= m_strings.size())
+				return;
+
+			for (uint32_t i=_numStrings; i<m_strings.size(); ++i)
+			{
+				m_totalSize -= 4 + (uint32_t)m_strings[i].size();
+				m_stringIndexMap.erase(m_strings[i]);
+			}
+			m_strings.resize(_numStrings);
+
+			for (PointerToIndexType::iterator it = m_pointerIndexMap.begin(); it != m_pointerIndexMap.end();)
+			{
+				if (it->second >= _numStrings)
+					it = m_pointerIndexMap.erase(it);
+				else
+					++it;
+			}
+		}
+	};
+
+} // namespace rprof
+
+#endif // RPROF_STRINGS_H
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef RPROF_THREAD_H
+#define RPROF_THREAD_H
+
+#include "rprof_platform.h"
+
+/*--------------------------------------------------------------------------
+ * Platforms with background thread support (used for recording)
+ *------------------------------------------------------------------------*/
+#define RPROF_THREADS_SUPPORTED (	RPROF_PLATFORM_WINDOWS		|| \
+									RPROF_PLATFORM_XBOXONE		|| \
+									RPROF_PLATFORM_LINUX		|| \
+									RPROF_PLATFORM_OSX			|| \
+									RPROF_PLATFORM_IOS			|| \
+									RPROF_PLATFORM_ANDROID		|| \
+									RPROF_PLATFORM_SWITCH		|| \
+									0)
+
+namespace rprof {
+
+	typedef void (*ThreadEntry)(void* _userData);
+
+#if RPROF_PLATFORM_WINDOWS || RPROF_PLATFORM_XBOXONE
+
+	class Thread
+	{
+		HANDLE		m_handle;
+		ThreadEntry	m_entry;
+		void*		m_userData;
+
+		static DWORD WINAPI threadFunc(LPVOID _arg)
+		{
+			Thread* thread = (Thread*)_arg;
+			thread->m_entry(thread->m_userData);
+			return 0;
+		}
+
+	public:
+		Thread() : m_handle(0) {}
+
+		inline bool start(ThreadEntry _entry, void* _userData)
+		{
+			m_entry		= _entry;
+			m_userData	= _userData;
+			m_handle	= CreateThread(0, 0, threadFunc, this, 0, 0);
+			return m_handle != 0;
+		}
+
+		inline void join()
+		{
+			if (!m_handle)
+				return;
+			WaitForSingleObject(m_handle, INFINITE);
+			CloseHandle(m_handle);
+			m_handle = 0;
+		}
+	};
+
+	class Event
+	{
+		HANDLE	m_event;
+
+		Event(const Event& _rhs);
+		Event& operator=(const Event& _rhs);
+
+	public:
+		inline Event()	{ m_event = CreateEvent(0, FALSE, FALSE, 0); }
+		inline ~Event()	{ CloseHandle(m_event); }
+
+		inline void signal()	{ SetEvent(m_event); }
+		inline void wait()		{ WaitForSingleObject(m_event, INFINITE); }
+	};
+
+#elif RPROF_THREADS_SUPPORTED
+
+	class Thread
+	{
+		pthread_t	m_handle;
+		bool		m_started;
+		ThreadEntry	m_entry;
+		void*		m_userData;
+
+		static void* threadFunc(void* _arg)
+		{
+			Thread* thread = (Thread*)_arg;
+			thread->m_entry(thread->m_userData);
+			return 0;
+		}
+
+	public:
+		Thread() : m_started(false) {}
+
+		inline bool start(ThreadEntry _entry, void* _userData)
+		{
+			m_entry		= _entry;
+			m_userData	= _userData;
+			m_started	= pthread_create(&m_handle, 0, threadFunc, this) == 0;
+			return m_started;
+		}
+
+		inline void join()
+		{
+			if (!m_started)
+				return;
+			pthread_join(m_handle, 0);
+			m_started = false;
+		}
+	};
+
+	class Event
+	{
+		pthread_mutex_t	m_mutex;
+		pthread_cond_t	m_cond;
+		bool			m_signaled;
+
+		Event(const Event& _rhs);
+		Event& operator=(const Event& _rhs);
+
+	public:
+		inline Event()
+			: m_signaled(false)
+		{
+			pthread_mutex_init(&m_mutex, 0);
+			pthread_cond_init(&m_cond, 0);
+		}
+
+		inline ~Event()
+		{
+			pthread_cond_destroy(&m_cond);
+			pthread_mutex_destroy(&m_mutex);
+		}
+
+		inline void signal()
+		{
+			pthread_mutex_lock(&m_mutex);
+			m_signaled = true;
+			pthread_cond_signal(&m_cond);
+			pthread_mutex_unlock(&m_mutex);
+		}
+
+		inline void wait()
+		{
+			pthread_mutex_lock(&m_mutex);
+			while (!m_signaled)
+				pthread_cond_wait(&m_cond, &m_mutex);
+			m_signaled = false;
+			pthread_mutex_unlock(&m_mutex);
+		}
+	};
+
+#endif
+
+} // namespace rprof
+
+#endif // RPROF_THREAD_H
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "rprof_platform.h"
+#include "rprof_tls.h"
+
+#if RPROF_PLATFORM_WINDOWS || RPROF_PLATFORM_XBOXONE
+
+#include <atomic>
+
+namespace rprof {
+
+	// There is a single slot user. Generation tells values set for a freed slot
+	// from values of the current one, TlsAlloc can return the same index again.
+	static std::atomic<TlsDestructor>	s_tlsDestructor(0);
+	static std::atomic<uint32_t>		s_tlsGeneration(0);
+
+	// Destroyed when owning thread exits
+	struct TlsExitHook
+	{
+		void*		m_value;
+		uint32_t	m_generation;
+
+		~TlsExitHook()
+		{
+			TlsDestructor destructor = s_tlsDestructor.load(std::memory_order_acquire);
+			if (m_value && destructor && (m_generation == s_tlsGeneration.load(std::memory_order_relaxed)))
+				destructor(m_value);
+		}
+	};
+
+	static thread_local TlsExitHook s_tlsExitHook;
+
+	uint32_t tlsAllocate(TlsDestructor _destructor)
+	{
+		s_tlsGeneration.fetch_add(1, std::memory_order_relaxed);
+		s_tlsDestructor.store(_destructor, std::memory_order_release);
+		return (uint32_t)TlsAlloc();
+	}
+
+	void tlsSetValue(uint32_t _handle, void* _value)
+	{
+		TlsSetValue(_handle, _value);
+		s_tlsExitHook.m_value		= _value;
+		s_tlsExitHook.m_generation	= s_tlsGeneration.load(std::memory_order_relaxed);
+	}
+
+	void tlsFree(uint32_t _handle)
+	{
+		s_tlsDestructor.store(0, std::memory_order_release);
+		TlsFree(_handle);
+	}
+
+} // namespace rprof
+
+#endif // RPROF_PLATFORM_WINDOWS || RPROF_PLATFORM_XBOXONE
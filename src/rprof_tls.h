@@ -11,34 +11,29 @@
 
 namespace rprof {
 
+	// Called on thread exit with non NULL value of the exiting thread
+	typedef void (*TlsDestructor)(void* _value);
+
 #if RPROF_PLATFORM_WINDOWS || RPROF_PLATFORM_XBOXONE
 
-	static inline uint32_t tlsAllocate()
-	{
-		return (uint32_t)TlsAlloc();
-	}
-
-	static inline void tlsSetValue(uint32_t _handle, void* _value)
-	{
-		TlsSetValue(_handle, _value);
-	}
+	// Values are thread local, fibers share the value of the thread running them.
+	// Fiber local storage callbacks run when a fiber is deleted, thread exit is
+	// detected with a thread_local object instead, see rprof_tls.cpp
+	uint32_t tlsAllocate(TlsDestructor _destructor = 0);
+	void tlsSetValue(uint32_t _handle, void* _value);
+	void tlsFree(uint32_t _handle);
 
 	static inline void* tlsGetValue(uint32_t _handle)
 	{
 		return TlsGetValue(_handle);
 	}
 
-	static inline void tlsFree(uint32_t _handle)
-	{
-		TlsFree(_handle);
-	}
-
 #elif RPROF_PLATFORM_PS4
 
-	static inline uint32_t tlsAllocate()
+	static inline uint32_t tlsAllocate(TlsDestructor _destructor = 0)
 	{
 		ScePthreadKey handle;
-		scePthreadKeyCreate(&handle, 0);
+		scePthreadKeyCreate(&handle, _destructor);
 		return handle;
 	}
 
@@ -59,10 +54,10 @@ namespace rprof {
 
 #elif RPROF_PLATFORM_POSIX
 
-	static inline uint32_t tlsAllocate()
+	static inline uint32_t tlsAllocate(TlsDestructor _destructor = 0)
 	{
 		pthread_key_t handle;
-		pthread_key_create(&handle, 0);
+		pthread_key_create(&handle, _destructor);
 		return (uint32_t)handle;
 	}
 
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+// Measures rprofLoad time per frame against number of scopes in the frame,
+// on synthetic frames of nested scopes spread over a few threads.
+
+#include "../../inc/rprof.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+static const char*		s_names[]		= { "frame", "update", "physics", "animation", "render", "culling", "draw", "upload" };
+static const uint32_t	s_numNames		= sizeof(s_names) / sizeof(s_names[0]);
+static const uint32_t	s_fanOut		= 4;
+static const uint32_t	s_maxDepth		= 6;
+static const uint32_t	s_numThreads	= 4;
+
+struct BenchFrame
+{
+	std::vector<ProfilerScope>		m_scopes;
+	std::vector<ProfilerScopeStats>	m_stats;
+	ProfilerThread					m_threads[s_numThreads];
+	ProfilerFrame					m_frame;
+};
+
+// Adds scope covering [_start, _end) and its children until _numScopes are added
+static void addScopes(BenchFrame& _bench, uint32_t _numScopes, uint64_t _threadID, uint32_t _level, uint64_t _start, uint64_t _end)
+{
+	if (_bench.m_scopes.size() == _numScopes)
+		return;
+
+	ProfilerScope scope;
+	memset(&scope, 0, sizeof(scope));
+	scope.m_start		= _start;
+	scope.m_end			= _end;
+	scope.m_threadID	= _threadID;
+	scope.m_name		= s_names[_level % s_numNames];
+	scope.m_file		= __FILE__;
+	scope.m_line		= _level;
+	scope.m_level		= _level;
+	_bench.m_scopes.push_back(scope);
+
+	if (_level == s_maxDepth)
+		return;
+
+	uint64_t step = (_end - _start) / s_fanOut;
+	for (uint32_t i=0; i<s_fanOut; ++i)
+		addScopes(_bench, _numScopes, _threadID, _level + 1, _start + step * i + 1, _start + step * (i + 1));
+}
+
+static void createFrame(BenchFrame& _bench, uint32_t _numScopes)
+{
+	const uint64_t treeTime = 1ull << 24;
+
+	_bench.m_scopes.clear();
+	_bench.m_scopes.reserve(_numScopes);
+	for (uint64_t tree=0; _bench.m_scopes.size() < _numScopes; ++tree)
+		addScopes(_bench, _numScopes, 1 + tree % s_numThreads, 0, tree * treeTime, (tree + 1) * treeTime - 1);
+
+	_bench.m_stats.assign(_numScopes, ProfilerScopeStats());
+	for (uint32_t i=0; i<_numScopes; ++i)
+		_bench.m_scopes[i].m_stats = &_bench.m_stats[i];
+
+	for (uint32_t i=0; i<s_numThreads; ++i)
+	{
+		memset(&_bench.m_threads[i], 0, sizeof(ProfilerThread));
+		_bench.m_threads[i].m_threadID	= 1 + i;
+		_bench.m_threads[i].m_name		= "worker";
+	}
+
+	ProfilerFrame& frame = _bench.m_frame;
+	memset(&frame, 0, sizeof(ProfilerFrame));
+	frame.m_scopes			= &_bench.m_scopes[0];
+	frame.m_numScopes		= _numScopes;
+	frame.m_threads			= _bench.m_threads;
+	frame.m_numThreads		= s_numThreads;
+	frame.m_startTime		= 0;
+	frame.m_endtime			= _bench.m_scopes.back().m_end + 1;
+	frame.m_CPUFrequency	= 1000000000;
+}
+
+int main(int _argc, char* _argv[])
+{
+	std::vector<uint32_t> counts;
+	for (int i=1; i<_argc; ++i)
+		counts.push_back((uint32_t)strtoul(_argv[i], 0, 10));
+	if (counts.empty())
+	{
+		counts.push_back(1000);
+		counts.push_back(4000);
+		counts.push_back(16000);
+	}
+
+	printf("%10s %10s %12s\n", "scopes", "loads", "ms per load");
+
+	BenchFrame bench;
+	for (size_t c=0; c<counts.size(); ++c)
+	{
+		if (!counts[c])
+			continue;
+
+		createFrame(bench, counts[c]);
+
+		std::vector<uint8_t> buffer(rprofSaveBound(&bench.m_frame));
+		int size = rprofSave(&bench.m_frame, &buffer[0], buffer.size());
+		if (!size)
+		{
+			fprintf(stderr, "rprof-bench: failed to save frame of %u scopes\n", counts[c]);
+			return 1;
+		}
+
+		// repeat loads for at least half a second
+		typedef std::chrono::steady_clock Clock;
+		Clock::time_point start = Clock::now();
+		double elapsed = 0.0;
+		uint32_t loads = 0;
+		while ((elapsed < 0.5) || (loads < 3))
+		{
+			ProfilerFrame frame;
+			rprofLoad(&frame, &buffer[0], (size_t)size);
+			rprofRelease(&frame);
+
+			++loads;
+			elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		}
+
+		printf("%10u %10u %12.3f\n", counts[c], loads, elapsed * 1000.0 / loads);
+	}
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#ifndef RPROF_CLI_H
+#define RPROF_CLI_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "../../inc/rprof.h"
+
+struct Options
+{
+	bool						m_json;
+	bool						m_frames;
+	bool						m_names;	// diff matches scopes by name instead of call path
+	uint32_t					m_top;		// 0 for all
+	uint32_t					m_threads;	// frame loading threads
+	const char*					m_output;	// output file, NULL for stdout
+	uint32_t					m_firstFrame;
+	uint32_t					m_numFrames;
+	double						m_tolerance;	// gate, relative p95 regression
+	double						m_alpha;		// gate, significance level
+	std::vector<const char*>	m_scopes;		// gated scopes
+	std::vector<const char*>	m_files;
+};
+
+// Mergeable quantile sketch, see sketch.cpp
+struct QuantileSketch
+{
+	std::vector<uint64_t>	m_buckets;
+	int32_t					m_firstBucket;
+	uint64_t				m_zeroCount;
+	uint64_t				m_count;
+	double					m_min;
+	double					m_max;
+};
+
+struct ScopeStats
+{
+	std::string		m_name;
+	uint64_t		m_count;
+	double			m_totalTime;			// inclusive, ms
+	double			m_selfTime;				// exclusive, ms
+	double			m_minTime;				// inclusive, per occurrence
+	double			m_maxTime;
+	QuantileSketch	m_times;				// inclusive, per occurrence
+};
+
+struct FrameStats
+{
+	uint32_t		m_index;				// in capture, frames that failed to load are skipped
+	double			m_time;					// ms
+	uint32_t		m_numScopes;
+	uint32_t		m_numThreads;
+	std::string		m_topScope;				// by exclusive time, empty if unknown
+	double			m_topScopeTime;
+};
+
+struct CaptureStats
+{
+	std::vector<FrameStats>	m_frames;
+	std::vector<ScopeStats>	m_scopes;		// by self time, descending
+	std::vector<ScopeStats>	m_callPaths;	// names are ';' separated paths, by self time, descending
+	uint64_t				m_clockFrequency;
+	uint64_t				m_numScopes;
+	uint32_t				m_maxThreads;
+	double					m_minFrameTime;
+	double					m_maxFrameTime;
+	double					m_totalFrameTime;
+};
+
+// stats.cpp
+double	clockToMs(uint64_t _clock, uint64_t _frequency);
+bool	collectCaptureStats(const char* _path, CaptureStats& _stats, uint32_t _numThreads, bool _callPaths);
+
+// sketch.cpp
+void	sketchInit(QuantileSketch& _sketch);
+void	sketchAdd(QuantileSketch& _sketch, double _value);
+void	sketchMerge(QuantileSketch& _sketch, const QuantileSketch& _other);
+double	sketchQuantile(const QuantileSketch& _sketch, double _quantile);
+
+// main.cpp
+void	jsonString(FILE* _out, const char* _str);
+int		writeFile(const void* _data, size_t _size, void* _userData);	// ProfilerWriteCallback to FILE*
+
+// commands
+int		commandSummary(const Options& _options);
+int		commandPercentiles(const Options& _options);
+int		commandTrace(const Options& _options);
+int		commandFolded(const Options& _options);
+int		commandDiff(const Options& _options);
+int		commandGate(const Options& _options);
+
+#endif // RPROF_CLI_H
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Capture with a range of frames, aggregated by call path
+struct DiffInput
+{
+	std::string			m_path;
+	uint32_t			m_firstFrame;
+	uint32_t			m_numFrames;
+	double				m_frameTime;	// per frame average, ms
+	ProfilerCallTree*	m_callTree;
+};
+
+// Frame range is given as 'capture.rprofm@N' or 'capture.rprofm@N-M' (inclusive),
+// --first and --count are used otherwise
+static void parseDiffInput(const char* _arg, const Options& _options, DiffInput& _input)
+{
+	_input.m_path		= _arg;
+	_input.m_firstFrame	= _options.m_firstFrame;
+	_input.m_numFrames	= _options.m_numFrames;
+
+	const char* range = strrchr(_arg, '@');
+	if (!range || (range[1] < '0') || (range[1] > '9'))
+		return;
+
+	char* end;
+	uint32_t first = (uint32_t)strtoul(range + 1, &end, 10);
+	uint32_t last = first;
+	if ((end[0] == '-') && (end[1] >= '0') && (end[1] <= '9'))
+		last = (uint32_t)strtoul(end + 1, &end, 10);
+
+	if (*end || (last < first))
+		return;
+
+	_input.m_path.assign(_arg, range - _arg);
+	_input.m_firstFrame	= first;
+	_input.m_numFrames	= last - first + 1;
+}
+
+static bool loadDiffInput(DiffInput& _input, ProfilerFrameArena* _arena)
+{
+	ProfilerCapture* capture = rprofOpenCapture(_input.m_path.c_str());
+	if (!capture)
+	{
+		fprintf(stderr, "rprof-cli: can not open capture '%s'\n", _input.m_path.c_str());
+		return false;
+	}
+
+	uint32_t numFrames = rprofGetCaptureFrameCount(capture);
+	uint32_t endFrame = (_input.m_firstFrame < numFrames) && (_input.m_numFrames < numFrames - _input.m_firstFrame) ? _input.m_firstFrame + _input.m_numFrames : numFrames;
+	uint64_t clockFrequency = rprofGetCaptureClockFrequency(capture);
+
+	double totalTime = 0.0;
+	for (uint32_t i=_input.m_firstFrame; i<endFrame; ++i)
+	{
+		ProfilerFrame frame;
+		if (!rprofLoadCaptureFrameToArena(capture, i, &frame, _arena))
+			continue;
+
+		rprofAddToCallTree(_input.m_callTree, &frame);
+		totalTime += clockToMs(frame.m_endtime - frame.m_startTime, frame.m_CPUFrequency ? frame.m_CPUFrequency : clockFrequency);
+	}
+
+	rprofCloseCapture(capture);
+
+	uint32_t loaded = rprofGetCallTreeFrameCount(_input.m_callTree);
+	_input.m_numFrames	= endFrame > _input.m_firstFrame ? endFrame - _input.m_firstFrame : 0;
+	_input.m_frameTime	= loaded ? totalTime / loaded : 0.0;
+
+	if (!loaded)
+	{
+		fprintf(stderr, "rprof-cli: no frames loaded from '%s'\n", _input.m_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+// ';' separated names of a call path
+static std::string getPathName(ProfilerCallTree* _tree, uint32_t _path)
+{
+	const ProfilerCallPath* paths;
+	rprofGetCallPaths(_tree, &paths, 0);
+
+	std::string name = paths[_path].m_name;
+	for (uint32_t parent=paths[_path].m_parent; parent!=RPROF_CALL_PATH_ROOT; parent=paths[parent].m_parent)
+		name = std::string(paths[parent].m_name) + ";" + name;
+	return name;
+}
+
+static std::string getDiffScopeName(const ProfilerDiffScope& _scope, DiffInput _inputs[2])
+{
+	if (_scope.m_path[1] != RPROF_CALL_PATH_ROOT)
+		return getPathName(_inputs[1].m_callTree, _scope.m_path[1]);
+	if (_scope.m_path[0] != RPROF_CALL_PATH_ROOT)
+		return getPathName(_inputs[0].m_callTree, _scope.m_path[0]);
+	return _scope.m_name;
+}
+
+static void printDiffText(const ProfilerDiffScope* _scopes, uint32_t _numScopes, DiffInput _inputs[2], bool _names)
+{
+	static const char* s_titles[2] = { "baseline", "candidate" };
+
+	for (uint32_t i=0; i<2; ++i)
+	{
+		const DiffInput& input = _inputs[i];
+		if (input.m_numFrames == 1)
+			printf("%-10s %s, frame %u, frame ms %.3f\n", s_titles[i], input.m_path.c_str(), input.m_firstFrame, input.m_frameTime);
+		else
+			printf("%-10s %s, frames %u-%u, frame ms avg %.3f\n", s_titles[i], input.m_path.c_str(),
+				input.m_firstFrame, input.m_firstFrame + input.m_numFrames - 1, input.m_frameTime);
+	}
+
+	double frameDelta = _inputs[1].m_frameTime - _inputs[0].m_frameTime;
+	printf("  frame ms delta %+.3f (%+.1f%%), per frame averages by change of self time\n",
+		frameDelta, _inputs[0].m_frameTime > 0.0 ? 100.0 * frameDelta / _inputs[0].m_frameTime : 0.0);
+
+	printf("\n  %12s %12s %12s %12s %10s  %s\n", "base self us", "self us", "delta us", "total d. us", "count d.", _names ? "scope" : "call path");
+	for (uint32_t i=0; i<_numScopes; ++i)
+	{
+		const ProfilerDiffScope& scope = _scopes[i];
+		printf("  %12.2f %12.2f %+12.2f %+12.2f %+10.2f  %s%s\n",
+			scope.m_exclusiveTime[0] * 1000.0, scope.m_exclusiveTime[1] * 1000.0,
+			(scope.m_exclusiveTime[1] - scope.m_exclusiveTime[0]) * 1000.0,
+			(scope.m_inclusiveTime[1] - scope.m_inclusiveTime[0]) * 1000.0,
+			scope.m_occurences[1] - scope.m_occurences[0],
+			getDiffScopeName(scope, _inputs).c_str(),
+			scope.m_occurences[0] == 0.0 ? " [new]" : (scope.m_occurences[1] == 0.0 ? " [removed]" : ""));
+	}
+	printf("\n");
+}
+
+static void printDiffJson(const ProfilerDiffScope* _scopes, uint32_t _numScopes, DiffInput _inputs[2], bool _names)
+{
+	static const char* s_titles[2] = { "baseline", "candidate" };
+
+	printf("{\"match\":\"%s\"", _names ? "name" : "callPath");
+	for (uint32_t i=0; i<2; ++i)
+	{
+		const DiffInput& input = _inputs[i];
+		printf(",\"%s\":{\"path\":", s_titles[i]);
+		jsonString(stdout, input.m_path.c_str());
+		printf(",\"firstFrame\":%u,\"frames\":%u,\"frameTime\":%.6f}", input.m_firstFrame, input.m_numFrames, input.m_frameTime);
+	}
+
+	printf(",\"scopes\":[");
+	for (uint32_t i=0; i<_numScopes; ++i)
+	{
+		const ProfilerDiffScope& scope = _scopes[i];
+		printf("%s{\"name\":", i ? "," : "");
+		jsonString(stdout, getDiffScopeName(scope, _inputs).c_str());
+		printf(",\"self\":[%.6f,%.6f],\"total\":[%.6f,%.6f],\"count\":[%.3f,%.3f]}",
+			scope.m_exclusiveTime[0], scope.m_exclusiveTime[1],
+			scope.m_inclusiveTime[0], scope.m_inclusiveTime[1],
+			scope.m_occurences[0], scope.m_occurences[1]);
+	}
+	printf("]}\n");
+}
+
+int commandDiff(const Options& _options)
+{
+	if (_options.m_files.size() != 2)
+	{
+		fprintf(stderr, "rprof-cli: diff takes baseline and candidate capture files\n");
+		return 1;
+	}
+
+	DiffInput inputs[2];
+	ProfilerFrameArena* arena = rprofCreateFrameArena();
+
+	int result = 0;
+	for (uint32_t i=0; i<2; ++i)
+	{
+		parseDiffInput(_options.m_files[i], _options, inputs[i]);
+		inputs[i].m_callTree = rprofCreateCallTree();
+		if (!loadDiffInput(inputs[i], arena))
+			result = 2;
+	}
+
+	rprofDestroyFrameArena(arena);
+
+	if (!result)
+	{
+		ProfilerDiffScope* scopes;
+		uint32_t numScopes = rprofDiffCallTrees(inputs[0].m_callTree, inputs[1].m_callTree, _options.m_names ? RPROF_DIFF_NAME : RPROF_DIFF_CALL_PATH, &scopes);
+		uint32_t numListed = _options.m_top && (numScopes > _options.m_top) ? _options.m_top : numScopes;
+
+		if (_options.m_json)
+			printDiffJson(scopes, numListed, inputs, _options.m_names);
+		else
+			printDiffText(scopes, numListed, inputs, _options.m_names);
+
+		rprofReleaseDiff(scopes);
+	}
+
+	for (uint32_t i=0; i<2; ++i)
+		rprofDestroyCallTree(inputs[i].m_callTree);
+	return result;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+// Call paths of all captures are aggregated to a single output
+int commandFolded(const Options& _options)
+{
+	ProfilerCallTree* tree = rprofCreateCallTree();
+	ProfilerFrameArena* arena = rprofCreateFrameArena();
+
+	int result = 0;
+	for (size_t i=0; i<_options.m_files.size(); ++i)
+	{
+		const char* path = _options.m_files[i];
+
+		ProfilerCapture* capture = rprofOpenCapture(path);
+		if (!capture)
+		{
+			fprintf(stderr, "rprof-cli: can not open capture '%s'\n", path);
+			result = 2;
+			continue;
+		}
+
+		uint32_t numFrames = rprofGetCaptureFrameCount(capture);
+		uint32_t endFrame = (_options.m_firstFrame < numFrames) && (_options.m_numFrames < numFrames - _options.m_firstFrame) ? _options.m_firstFrame + _options.m_numFrames : numFrames;
+		for (uint32_t j=_options.m_firstFrame; j<endFrame; ++j)
+		{
+			ProfilerFrame frame;
+			if (rprofLoadCaptureFrameToArena(capture, j, &frame, arena))
+				rprofAddToCallTree(tree, &frame);
+		}
+
+		rprofCloseCapture(capture);
+	}
+
+	FILE* out = _options.m_output ? fopen(_options.m_output, "wb") : stdout;
+	if (out)
+	{
+		if (!rprofExportFoldedStacks(tree, writeFile, out))
+			result = 2;
+		if (out != stdout)
+			result = fclose(out) ? 2 : result;
+		else
+			fflush(stdout);
+
+		if (result)
+			fprintf(stderr, "rprof-cli: failed writing folded stacks\n");
+	}
+	else
+	{
+		fprintf(stderr, "rprof-cli: can not create '%s'\n", _options.m_output);
+		result = 2;
+	}
+
+	rprofDestroyFrameArena(arena);
+	rprofDestroyCallTree(tree);
+	return result;
+}
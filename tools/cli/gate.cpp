@@ -0,0 +1,326 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+// Gated percentile of per frame scope self times
+static const double		s_gateQuantile		= 0.95;
+
+// Mann-Whitney U test uses normal approximation, not valid for small samples
+static const uint32_t	s_gateMinFrames		= 8;
+
+struct GateScope
+{
+	std::string		m_name;
+	double			m_tolerance;		// relative, 0.05 for 5%
+};
+
+// Per frame self times of gated scopes in one capture
+struct GateCapture
+{
+	ProfilerCapture*					m_capture;
+	uint64_t							m_clockFrequency;
+	uint32_t							m_firstFrame;
+	uint32_t							m_endFrame;
+	const std::vector<GateScope>*		m_scopes;
+	std::vector<std::vector<double> >	m_totals;		// per scope, per frame, ms
+	std::vector<uint8_t>				m_loaded;		// per frame
+	std::vector<uint8_t>				m_found;		// per scope, found in any frame
+};
+
+struct GateResult
+{
+	double		m_quantiles[2][2];		// p50 and p95 of baseline and candidate
+	double		m_change;				// relative change of p95
+	double		m_pValue;				// candidate is not slower than baseline
+	bool		m_significant;
+	bool		m_regressed;
+};
+
+// Scope tolerance is given as 'name:percent', --tolerance is used otherwise
+static void parseGateScope(const char* _arg, double _tolerance, GateScope& _scope)
+{
+	_scope.m_name		= _arg;
+	_scope.m_tolerance	= _tolerance;
+
+	const char* tolerance = strrchr(_arg, ':');
+	if (!tolerance || !tolerance[1])
+		return;
+
+	char* end;
+	double percent = strtod(tolerance + 1, &end);
+	if (*end || (percent < 0.0))
+		return;
+
+	_scope.m_name.assign(_arg, tolerance - _arg);
+	_scope.m_tolerance = percent / 100.0;
+}
+
+// Names of a frame are unique in m_scopesStats. Exclusive time of all
+// occurrences is summed, inclusive time would count nested and recursive
+// occurrences of a scope more than once.
+static void gateFrame(ProfilerFrame* _frame, uint32_t _index, uint32_t /*_worker*/, void* _userData)
+{
+	GateCapture& capture = *(GateCapture*)_userData;
+
+	uint64_t frequency = _frame->m_CPUFrequency ? _frame->m_CPUFrequency : capture.m_clockFrequency;
+	uint32_t frame = _index - capture.m_firstFrame;
+	capture.m_loaded[frame] = 1;
+
+	const std::vector<GateScope>& scopes = *capture.m_scopes;
+	for (uint32_t i=0; i<_frame->m_numScopesStats; ++i)
+	{
+		const ProfilerScope& scope = _frame->m_scopesStats[i];
+		for (size_t j=0; j<scopes.size(); ++j)
+			if (strcmp(scope.m_name, scopes[j].m_name.c_str()) == 0)
+				capture.m_totals[j][frame] += clockToMs(scope.m_stats->m_exclusiveTimeTotal, frequency);
+	}
+}
+
+static bool loadGateCapture(const char* _path, const Options& _options, const std::vector<GateScope>& _scopes, GateCapture& _capture)
+{
+	_capture.m_capture = rprofOpenCapture(_path);
+	if (!_capture.m_capture)
+	{
+		fprintf(stderr, "rprof-cli: can not open capture '%s'\n", _path);
+		return false;
+	}
+
+	uint32_t numFrames = rprofGetCaptureFrameCount(_capture.m_capture);
+	_capture.m_clockFrequency	= rprofGetCaptureClockFrequency(_capture.m_capture);
+	_capture.m_firstFrame		= _options.m_firstFrame;
+	_capture.m_endFrame			= (_options.m_firstFrame < numFrames) && (_options.m_numFrames < numFrames - _options.m_firstFrame) ? _options.m_firstFrame + _options.m_numFrames : numFrames;
+	_capture.m_scopes			= &_scopes;
+
+	uint32_t rangeFrames = _capture.m_endFrame > _capture.m_firstFrame ? _capture.m_endFrame - _capture.m_firstFrame : 0;
+	_capture.m_totals.assign(_scopes.size(), std::vector<double>(rangeFrames, 0.0));
+	_capture.m_loaded.assign(rangeFrames, 0);
+
+	rprofProcessCaptureFrames(_capture.m_capture, gateFrame, &_capture, _options.m_threads, _capture.m_firstFrame, rangeFrames);
+	rprofCloseCapture(_capture.m_capture);
+
+	// frames failing to load are not samples
+	_capture.m_found.assign(_scopes.size(), 0);
+	for (size_t i=0; i<_scopes.size(); ++i)
+	{
+		std::vector<double>& totals = _capture.m_totals[i];
+		size_t numLoaded = 0;
+		for (size_t j=0; j<totals.size(); ++j)
+		{
+			if (!_capture.m_loaded[j])
+				continue;
+			_capture.m_found[i] |= totals[j] > 0.0 ? 1 : 0;
+			totals[numLoaded++] = totals[j];
+		}
+		totals.resize(numLoaded);
+		std::sort(totals.begin(), totals.end());
+	}
+
+	uint32_t numLoaded = (uint32_t)std::count(_capture.m_loaded.begin(), _capture.m_loaded.end(), 1);
+	if (numLoaded < s_gateMinFrames)
+	{
+		fprintf(stderr, "rprof-cli: '%s' has %u frames in range, at least %u are needed\n", _path, numLoaded, s_gateMinFrames);
+		return false;
+	}
+	return true;
+}
+
+// Linear interpolation between closest ranks of sorted values
+static double getQuantile(const std::vector<double>& _sorted, double _quantile)
+{
+	if (_sorted.empty())
+		return 0.0;
+
+	double rank = _quantile * (double)(_sorted.size() - 1);
+	size_t lower = (size_t)rank;
+	size_t upper = std::min(lower + 1, _sorted.size() - 1);
+	return _sorted[lower] + (_sorted[upper] - _sorted[lower]) * (rank - (double)lower);
+}
+
+// One sided Mann-Whitney U test of candidate values being larger than baseline
+// ones, normal approximation with tie and continuity correction. Returns p-value.
+static double mannWhitneyGreater(const std::vector<double>& _baseline, const std::vector<double>& _candidate)
+{
+	double n0 = (double)_baseline.size();
+	double n1 = (double)_candidate.size();
+	double n = n0 + n1;
+
+	// both inputs are sorted, ranks are assigned while merging them
+	double rankSum = 0.0;
+	double ties = 0.0;
+	size_t i0 = 0, i1 = 0;
+	while ((i0 < _baseline.size()) || (i1 < _candidate.size()))
+	{
+		double value = (i1 == _candidate.size()) || ((i0 < _baseline.size()) && (_baseline[i0] < _candidate[i1])) ? _baseline[i0] : _candidate[i1];
+
+		size_t count0 = 0, count1 = 0;
+		while ((i0 < _baseline.size()) && (_baseline[i0] == value))		{ ++i0; ++count0; }
+		while ((i1 < _candidate.size()) && (_candidate[i1] == value))	{ ++i1; ++count1; }
+
+		// equal values share average of their ranks
+		double count = (double)(count0 + count1);
+		double firstRank = (double)(i0 + i1) - count + 1.0;
+		rankSum += (double)count1 * (firstRank + (count - 1.0) * 0.5);
+		ties += count * count * count - count;
+	}
+
+	double u = rankSum - n1 * (n1 + 1.0) * 0.5;
+	double mean = n0 * n1 * 0.5;
+	double variance = n0 * n1 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+	if (variance <= 0.0)
+		return 1.0;
+
+	double z = (u - mean - 0.5) / sqrt(variance);
+	return 0.5 * erfc(z / sqrt(2.0));
+}
+
+static void gateScope(const std::vector<double>& _baseline, const std::vector<double>& _candidate, const GateScope& _scope, double _alpha, GateResult& _result)
+{
+	const std::vector<double>* totals[2] = { &_baseline, &_candidate };
+	for (uint32_t i=0; i<2; ++i)
+	{
+		_result.m_quantiles[i][0] = getQuantile(*totals[i], 0.5);
+		_result.m_quantiles[i][1] = getQuantile(*totals[i], s_gateQuantile);
+	}
+
+	double base = _result.m_quantiles[0][1];
+	double candidate = _result.m_quantiles[1][1];
+	if (base > 0.0)
+		_result.m_change = (candidate - base) / base;
+	else
+		_result.m_change = candidate > 0.0 ? HUGE_VAL : 0.0;
+
+	_result.m_pValue		= mannWhitneyGreater(_baseline, _candidate);
+	_result.m_significant	= _result.m_pValue < _alpha;
+	_result.m_regressed		= _result.m_significant && (_result.m_change > _scope.m_tolerance);
+}
+
+static const char* getGateVerdict(const GateResult& _result, const GateScope& _scope)
+{
+	if (_result.m_regressed)
+		return "FAIL";
+	return _result.m_change > _scope.m_tolerance ? "noise" : "pass";
+}
+
+static void printGateText(const char* _paths[2], GateCapture _captures[2], const std::vector<GateScope>& _scopes, const std::vector<GateResult>& _results, double _alpha)
+{
+	static const char* s_titles[2] = { "baseline", "candidate" };
+
+	for (uint32_t i=0; i<2; ++i)
+		printf("%-10s %s, frames %u\n", s_titles[i], _paths[i], (uint32_t)_captures[i].m_totals[0].size());
+	printf("  per frame scope self times, p%g regression past tolerance with one sided Mann-Whitney U test p < %g\n", s_gateQuantile * 100.0, _alpha);
+
+	printf("\n  %12s %12s %12s %12s %10s %10s %10s %7s  %s\n", "base p50 us", "base p95 us", "p50 us", "p95 us", "p95 change", "tolerance", "p-value", "result", "scope");
+	uint32_t numRegressed = 0;
+	for (size_t i=0; i<_scopes.size(); ++i)
+	{
+		const GateResult& result = _results[i];
+		printf("  %12.2f %12.2f %12.2f %12.2f %+9.1f%% %9.1f%% %10.2g %7s  %s\n",
+			result.m_quantiles[0][0] * 1000.0, result.m_quantiles[0][1] * 1000.0,
+			result.m_quantiles[1][0] * 1000.0, result.m_quantiles[1][1] * 1000.0,
+			result.m_change * 100.0, _scopes[i].m_tolerance * 100.0, result.m_pValue,
+			getGateVerdict(result, _scopes[i]), _scopes[i].m_name.c_str());
+		numRegressed += result.m_regressed ? 1 : 0;
+	}
+
+	if (numRegressed)
+		printf("\ngate failed, %u of %u scopes regressed\n", numRegressed, (uint32_t)_scopes.size());
+	else
+		printf("\ngate passed\n");
+}
+
+static void printGateJson(const char* _paths[2], GateCapture _captures[2], const std::vector<GateScope>& _scopes, const std::vector<GateResult>& _results, double _alpha)
+{
+	static const char* s_titles[2] = { "baseline", "candidate" };
+
+	bool passed = true;
+	for (size_t i=0; i<_results.size(); ++i)
+		passed &= !_results[i].m_regressed;
+
+	printf("{\"passed\":%s,\"quantile\":%g,\"alpha\":%g", passed ? "true" : "false", s_gateQuantile, _alpha);
+	for (uint32_t i=0; i<2; ++i)
+	{
+		printf(",\"%s\":{\"path\":", s_titles[i]);
+		jsonString(stdout, _paths[i]);
+		printf(",\"frames\":%u}", (uint32_t)_captures[i].m_totals[0].size());
+	}
+
+	printf(",\"scopes\":[");
+	for (size_t i=0; i<_scopes.size(); ++i)
+	{
+		const GateResult& result = _results[i];
+		printf("%s{\"name\":", i ? "," : "");
+		jsonString(stdout, _scopes[i].m_name.c_str());
+		printf(",\"tolerance\":%g,\"baseline\":{\"p50\":%.6f,\"p95\":%.6f},\"candidate\":{\"p50\":%.6f,\"p95\":%.6f}",
+			_scopes[i].m_tolerance, result.m_quantiles[0][0], result.m_quantiles[0][1], result.m_quantiles[1][0], result.m_quantiles[1][1]);
+
+		// JSON has no infinity, change of scopes missing in baseline is null
+		if (result.m_change == HUGE_VAL)
+			printf(",\"change\":null");
+		else
+			printf(",\"change\":%.6f", result.m_change);
+		printf(",\"pValue\":%.6g,\"regressed\":%s}", result.m_pValue, result.m_regressed ? "true" : "false");
+	}
+	printf("]}\n");
+}
+
+int commandGate(const Options& _options)
+{
+	if (_options.m_files.size() != 2)
+	{
+		fprintf(stderr, "rprof-cli: gate takes baseline and candidate capture files\n");
+		return 1;
+	}
+
+	if (_options.m_scopes.empty())
+	{
+		fprintf(stderr, "rprof-cli: gate needs at least one --scope\n");
+		return 1;
+	}
+
+	std::vector<GateScope> scopes(_options.m_scopes.size());
+	for (size_t i=0; i<scopes.size(); ++i)
+		parseGateScope(_options.m_scopes[i], _options.m_tolerance, scopes[i]);
+
+	const char* paths[2] = { _options.m_files[0], _options.m_files[1] };
+	GateCapture captures[2];
+	for (uint32_t i=0; i<2; ++i)
+		if (!loadGateCapture(paths[i], _options, scopes, captures[i]))
+			return 2;
+
+	// misspelled scope would otherwise always pass
+	int result = 0;
+	for (size_t i=0; i<scopes.size(); ++i)
+	{
+		if (!captures[0].m_found[i] && !captures[1].m_found[i])
+		{
+			fprintf(stderr, "rprof-cli: scope '%s' is not found in either capture\n", scopes[i].m_name.c_str());
+			result = 2;
+		}
+	}
+
+	if (result)
+		return result;
+
+	std::vector<GateResult> results(scopes.size());
+	for (size_t i=0; i<scopes.size(); ++i)
+	{
+		gateScope(captures[0].m_totals[i], captures[1].m_totals[i], scopes[i], _options.m_alpha, results[i]);
+		if (results[i].m_regressed)
+			result = 3;
+	}
+
+	if (_options.m_json)
+		printGateJson(paths, captures, scopes, results, _options.m_alpha);
+	else
+		printGateText(paths, captures, scopes, results, _options.m_alpha);
+
+	return result;
+}
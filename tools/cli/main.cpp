@@ -0,0 +1,171 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+struct Command
+{
+	const char*	m_name;
+	int			(*m_func)(const Options&);
+	const char*	m_description;
+};
+
+static const Command s_commands[] =
+{
+	{ "summary",		commandSummary,		"per frame and per scope statistics" },
+	{ "percentiles",	commandPercentiles,	"per scope and per call path percentiles of scope times" },
+	{ "trace",			commandTrace,		"export to Chrome Trace Event JSON (chrome://tracing, Perfetto)" },
+	{ "folded",			commandFolded,		"export folded stacks of call paths for flame graph tools" },
+	{ "diff",			commandDiff,		"per scope changes between two captures or frame ranges" },
+	{ "gate",			commandGate,		"fail when p95 of scopes regresses from baseline, for CI" },
+};
+
+static const uint32_t s_numCommands = sizeof(s_commands) / sizeof(s_commands[0]);
+
+static void printUsage()
+{
+	printf("usage: rprof-cli <command> [options] <capture>...\n\n");
+	printf("Reads single (.rprof) and multi frame (.rprofm) captures.\n\n");
+	printf("commands:\n");
+	for (uint32_t i=0; i<s_numCommands; ++i)
+		printf("  %-12s %s\n", s_commands[i].m_name, s_commands[i].m_description);
+	printf("\noptions:\n");
+	printf("  --json       output JSON instead of text\n");
+	printf("  --top N      number of scopes to list, 0 for all (default 20)\n");
+	printf("  --frames     list every frame\n");
+	printf("  --threads N  number of threads loading frames (default CPU cores)\n");
+	printf("  --output F   output file of exporting commands (default stdout)\n");
+	printf("  --first N    first frame exported (default 0)\n");
+	printf("  --count N    number of frames exported (default all)\n");
+	printf("  --names      diff scopes by name instead of call path\n");
+	printf("  --scope S    gated scope, S:PCT overrides tolerance, repeatable\n");
+	printf("  --tolerance  gate p95 regression tolerance in percent (default 5)\n");
+	printf("  --alpha A    gate significance level of Mann-Whitney U test (default 0.01)\n");
+	printf("\ndiff takes baseline and candidate captures, capture@N or capture@N-M selects frames.\n");
+	printf("gate takes baseline and candidate captures, exits with 3 if a scope regressed.\n");
+}
+
+void jsonString(FILE* _out, const char* _str)
+{
+	fputc('"', _out);
+	for (; *_str; ++_str)
+	{
+		unsigned char c = (unsigned char)*_str;
+		switch (c)
+		{
+		case '"':	fputs("\\\"", _out);	break;
+		case '\\':	fputs("\\\\", _out);	break;
+		case '\n':	fputs("\\n", _out);		break;
+		case '\r':	fputs("\\r", _out);		break;
+		case '\t':	fputs("\\t", _out);		break;
+		default:
+			if (c < 0x20)
+				fprintf(_out, "\\u%04x", c);
+			else
+				fputc(c, _out);
+		};
+	}
+	fputc('"', _out);
+}
+
+int writeFile(const void* _data, size_t _size, void* _userData)
+{
+	return fwrite(_data, 1, _size, (FILE*)_userData) == _size ? 1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		printUsage();
+		return 1;
+	}
+
+	const Command* command = 0;
+	for (uint32_t i=0; i<s_numCommands; ++i)
+		if (strcmp(argv[1], s_commands[i].m_name) == 0)
+			command = &s_commands[i];
+
+	if (!command)
+	{
+		if (strcmp(argv[1], "--help") && strcmp(argv[1], "-h"))
+			fprintf(stderr, "rprof-cli: unknown command '%s'\n\n", argv[1]);
+		printUsage();
+		return 1;
+	}
+
+	Options options;
+	options.m_json			= false;
+	options.m_frames		= false;
+	options.m_names			= false;
+	options.m_top			= 20;
+	options.m_threads		= std::max(std::thread::hardware_concurrency(), 1u);
+	options.m_output		= 0;
+	options.m_firstFrame	= 0;
+	options.m_numFrames		= 0xffffffff;
+	options.m_tolerance		= 0.05;
+	options.m_alpha			= 0.01;
+
+	for (int i=2; i<argc; ++i)
+	{
+		const char* arg = argv[i];
+
+		if (strcmp(arg, "--json") == 0)
+			options.m_json = true;
+		else
+		if (strcmp(arg, "--frames") == 0)
+			options.m_frames = true;
+		else
+		if (strcmp(arg, "--names") == 0)
+			options.m_names = true;
+		else
+		if ((strcmp(arg, "--top") == 0) && (i + 1 < argc))
+			options.m_top = (uint32_t)strtoul(argv[++i], 0, 10);
+		else
+		if ((strcmp(arg, "--threads") == 0) && (i + 1 < argc))
+			options.m_threads = std::max((uint32_t)strtoul(argv[++i], 0, 10), 1u);
+		else
+		if ((strcmp(arg, "--output") == 0) && (i + 1 < argc))
+			options.m_output = argv[++i];
+		else
+		if ((strcmp(arg, "--first") == 0) && (i + 1 < argc))
+			options.m_firstFrame = (uint32_t)strtoul(argv[++i], 0, 10);
+		else
+		if ((strcmp(arg, "--count") == 0) && (i + 1 < argc))
+			options.m_numFrames = (uint32_t)strtoul(argv[++i], 0, 10);
+		else
+		if ((strcmp(arg, "--scope") == 0) && (i + 1 < argc))
+			options.m_scopes.push_back(argv[++i]);
+		else
+		if ((strcmp(arg, "--tolerance") == 0) && (i + 1 < argc))
+			options.m_tolerance = std::max(strtod(argv[++i], 0), 0.0) / 100.0;
+		else
+		if ((strcmp(arg, "--alpha") == 0) && (i + 1 < argc))
+			options.m_alpha = strtod(argv[++i], 0);
+		else
+		if ((arg[0] == '-') && arg[1])
+		{
+			fprintf(stderr, "rprof-cli: unknown option '%s'\n\n", arg);
+			printUsage();
+			return 1;
+		}
+		else
+			options.m_files.push_back(arg);
+	}
+
+	if (options.m_files.empty())
+	{
+		fprintf(stderr, "rprof-cli: no capture files\n\n");
+		printUsage();
+		return 1;
+	}
+
+	return command->m_func(options);
+}
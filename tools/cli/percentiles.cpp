@@ -0,0 +1,128 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+#include <algorithm>
+
+static const double			s_quantiles[]		= { 0.5, 0.9, 0.99, 0.999 };
+static const char* const	s_quantileNames[]	= { "p50", "p90", "p99", "p99.9" };
+static const uint32_t		s_numQuantiles		= sizeof(s_quantiles) / sizeof(s_quantiles[0]);
+
+struct ScopePercentiles
+{
+	const ScopeStats*	m_stats;
+	double				m_values[s_numQuantiles];
+};
+
+// Tail first, by p99
+struct ScopeTailOrder
+{
+	bool operator()(const ScopePercentiles& _a, const ScopePercentiles& _b) const
+	{
+		if (_a.m_values[2] != _b.m_values[2])	return _a.m_values[2] > _b.m_values[2];
+		return _a.m_stats->m_name < _b.m_stats->m_name;
+	}
+};
+
+static void getPercentiles(const std::vector<ScopeStats>& _scopes, uint32_t _top, std::vector<ScopePercentiles>& _percentiles)
+{
+	_percentiles.resize(_scopes.size());
+	for (size_t i=0; i<_scopes.size(); ++i)
+	{
+		_percentiles[i].m_stats = &_scopes[i];
+		for (uint32_t j=0; j<s_numQuantiles; ++j)
+			_percentiles[i].m_values[j] = sketchQuantile(_scopes[i].m_times, s_quantiles[j]);
+	}
+
+	std::sort(_percentiles.begin(), _percentiles.end(), ScopeTailOrder());
+	if (_top && (_percentiles.size() > _top))
+		_percentiles.resize(_top);
+}
+
+static void printPercentilesText(const char* _title, const std::vector<ScopePercentiles>& _percentiles)
+{
+	printf("\n  %10s", "count");
+	for (uint32_t i=0; i<s_numQuantiles; ++i)
+		printf(" %7s us", s_quantileNames[i]);
+	printf(" %10s  %s\n", "max us", _title);
+
+	for (size_t i=0; i<_percentiles.size(); ++i)
+	{
+		const ScopePercentiles& scope = _percentiles[i];
+		printf("  %10llu", (unsigned long long)scope.m_stats->m_count);
+		for (uint32_t j=0; j<s_numQuantiles; ++j)
+			printf(" %10.2f", scope.m_values[j] * 1000.0);
+		printf(" %10.2f  %s\n", scope.m_stats->m_maxTime * 1000.0, scope.m_stats->m_name.c_str());
+	}
+}
+
+static void printPercentilesJson(const char* _name, const std::vector<ScopePercentiles>& _percentiles)
+{
+	printf(",\"%s\":[", _name);
+	for (size_t i=0; i<_percentiles.size(); ++i)
+	{
+		const ScopePercentiles& scope = _percentiles[i];
+		printf("%s{\"name\":", i ? "," : "");
+		jsonString(stdout, scope.m_stats->m_name.c_str());
+		printf(",\"count\":%llu", (unsigned long long)scope.m_stats->m_count);
+		for (uint32_t j=0; j<s_numQuantiles; ++j)
+			printf(",\"%s\":%.6f", s_quantileNames[j], scope.m_values[j]);
+		printf(",\"max\":%.6f}", scope.m_stats->m_maxTime);
+	}
+	printf("]");
+}
+
+int commandPercentiles(const Options& _options)
+{
+	int result = 0;
+
+	if (_options.m_json)
+		printf("[");
+
+	bool first = true;
+	for (size_t i=0; i<_options.m_files.size(); ++i)
+	{
+		const char* path = _options.m_files[i];
+
+		CaptureStats stats;
+		if (!collectCaptureStats(path, stats, _options.m_threads, true))
+		{
+			fprintf(stderr, "rprof-cli: can not open capture '%s'\n", path);
+			result = 2;
+			continue;
+		}
+
+		std::vector<ScopePercentiles> scopes;
+		std::vector<ScopePercentiles> callPaths;
+		getPercentiles(stats.m_scopes, _options.m_top, scopes);
+		getPercentiles(stats.m_callPaths, _options.m_top, callPaths);
+
+		if (_options.m_json)
+		{
+			if (!first)
+				printf(",\n");
+			printf("{\"path\":");
+			jsonString(stdout, path);
+			printf(",\"frames\":%u", (uint32_t)stats.m_frames.size());
+			printPercentilesJson("scopes", scopes);
+			printPercentilesJson("callPaths", callPaths);
+			printf("}");
+		}
+		else
+		{
+			printf("%s\n", path);
+			printf("  frames %u, scopes %llu, inclusive scope times, 1%% relative error\n", (uint32_t)stats.m_frames.size(), (unsigned long long)stats.m_numScopes);
+			printPercentilesText("scope", scopes);
+			printPercentilesText("call path", callPaths);
+			printf("\n");
+		}
+		first = false;
+	}
+
+	if (_options.m_json)
+		printf("]\n");
+	return result;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+#include <math.h>
+#include <algorithm>
+
+// Values are counted in logarithmic buckets, bucket i holds values in range
+// (gamma^(i-1), gamma^i] and reports 2*gamma^i/(gamma+1), which is within
+// s_sketchAccuracy of any value in the bucket. Number of buckets depends on
+// range of values only, lowest buckets are collapsed when there are more than
+// s_sketchMaxBuckets so memory stays bounded and high quantiles stay exact.
+static const double		s_sketchAccuracy	= 0.01;
+static const double		s_sketchGamma		= (1.0 + s_sketchAccuracy) / (1.0 - s_sketchAccuracy);
+static const double		s_sketchMinValue	= 1e-6;		// 1 ns, smaller values are counted as zero
+static const uint32_t	s_sketchMaxBuckets	= 1024;		// ~9 decades of values at 1% accuracy
+
+static int32_t getBucketIndex(double _value)
+{
+	return (int32_t)ceil(log(_value) / log(s_sketchGamma));
+}
+
+// Resizes bucket range to include [_first, _last], buckets below the range
+// allowed by s_sketchMaxBuckets are added to the lowest one kept
+static void sketchCover(QuantileSketch& _sketch, int32_t _first, int32_t _last)
+{
+	int32_t numBuckets = (int32_t)_sketch.m_buckets.size();
+	if (numBuckets)
+	{
+		if ((_first >= _sketch.m_firstBucket) && (_last < _sketch.m_firstBucket + numBuckets))
+			return;
+
+		_first	= std::min(_first, _sketch.m_firstBucket);
+		_last	= std::max(_last, _sketch.m_firstBucket + numBuckets - 1);
+	}
+
+	if (_last - _first + 1 > (int32_t)s_sketchMaxBuckets)
+		_first = _last - (int32_t)s_sketchMaxBuckets + 1;
+
+	std::vector<uint64_t> buckets(_last - _first + 1, 0);
+	for (int32_t i=0; i<numBuckets; ++i)
+		buckets[std::max(_sketch.m_firstBucket + i, _first) - _first] += _sketch.m_buckets[i];
+
+	_sketch.m_buckets.swap(buckets);
+	_sketch.m_firstBucket = _first;
+}
+
+void sketchInit(QuantileSketch& _sketch)
+{
+	_sketch.m_buckets.clear();
+	_sketch.m_firstBucket	= 0;
+	_sketch.m_zeroCount		= 0;
+	_sketch.m_count			= 0;
+	_sketch.m_min			= 0.0;
+	_sketch.m_max			= 0.0;
+}
+
+void sketchAdd(QuantileSketch& _sketch, double _value)
+{
+	if (!_sketch.m_count || (_sketch.m_min > _value))
+		_sketch.m_min = _value;
+	if (!_sketch.m_count || (_sketch.m_max < _value))
+		_sketch.m_max = _value;
+	_sketch.m_count++;
+
+	if (_value < s_sketchMinValue)
+	{
+		_sketch.m_zeroCount++;
+		return;
+	}
+
+	int32_t index = getBucketIndex(_value);
+	sketchCover(_sketch, index, index);
+	_sketch.m_buckets[std::max(index, _sketch.m_firstBucket) - _sketch.m_firstBucket]++;
+}
+
+void sketchMerge(QuantileSketch& _sketch, const QuantileSketch& _other)
+{
+	if (!_other.m_count)
+		return;
+
+	if (!_sketch.m_count || (_sketch.m_min > _other.m_min))
+		_sketch.m_min = _other.m_min;
+	if (!_sketch.m_count || (_sketch.m_max < _other.m_max))
+		_sketch.m_max = _other.m_max;
+	_sketch.m_count		+= _other.m_count;
+	_sketch.m_zeroCount	+= _other.m_zeroCount;
+
+	int32_t numBuckets = (int32_t)_other.m_buckets.size();
+	if (!numBuckets)
+		return;
+
+	sketchCover(_sketch, _other.m_firstBucket, _other.m_firstBucket + numBuckets - 1);
+	for (int32_t i=0; i<numBuckets; ++i)
+		_sketch.m_buckets[std::max(_other.m_firstBucket + i, _sketch.m_firstBucket) - _sketch.m_firstBucket] += _other.m_buckets[i];
+}
+
+double sketchQuantile(const QuantileSketch& _sketch, double _quantile)
+{
+	if (!_sketch.m_count)
+		return 0.0;
+
+	if (_quantile >= 1.0)
+		return _sketch.m_max;
+
+	uint64_t rank = (uint64_t)(std::max(_quantile, 0.0) * (double)(_sketch.m_count - 1));
+	if (rank < _sketch.m_zeroCount)
+		return _sketch.m_min;
+
+	uint64_t count = _sketch.m_zeroCount;
+	for (size_t i=0; i<_sketch.m_buckets.size(); ++i)
+	{
+		count += _sketch.m_buckets[i];
+		if (count > rank)
+		{
+			double value = 2.0 * pow(s_sketchGamma, (double)(_sketch.m_firstBucket + (int32_t)i)) / (s_sketchGamma + 1.0);
+			return std::min(std::max(value, _sketch.m_min), _sketch.m_max);
+		}
+	}
+	return _sketch.m_max;
+}
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+
+double clockToMs(uint64_t _clock, uint64_t _frequency)
+{
+	return _frequency ? (double)_clock * 1000.0 / (double)_frequency : 0.0;
+}
+
+struct ScopeSelfTimeOrder
+{
+	bool operator()(const ScopeStats& _a, const ScopeStats& _b) const
+	{
+		if (_a.m_selfTime != _b.m_selfTime)	return _a.m_selfTime > _b.m_selfTime;
+		return _a.m_name < _b.m_name;
+	}
+};
+
+// Scope stats gathered by one worker, merged once all frames are processed
+struct WorkerStats
+{
+	// names of a loaded frame are stored once, scopes with the same name
+	// share the pointer and only first one per frame is looked up by name
+	std::unordered_map<std::string, uint32_t>	m_nameIndices;
+	std::unordered_map<const char*, uint32_t>	m_pointerIndices;
+	std::vector<ScopeStats>						m_scopes;
+
+	// stats per call path of m_callTree
+	ProfilerCallTree*							m_callTree;
+	std::vector<ScopeStats>						m_pathStats;
+	std::vector<uint32_t>						m_scopePaths;
+};
+
+struct CollectContext
+{
+	ProfilerCapture*			m_capture;
+	uint64_t					m_clockFrequency;
+	bool						m_callPaths;
+	std::vector<FrameStats>		m_frames;			// one per capture frame
+	std::vector<uint8_t>		m_loaded;
+	std::vector<WorkerStats>	m_workers;
+};
+
+static void initScopeStats(ScopeStats& _stats, const std::string& _name)
+{
+	_stats.m_name		= _name;
+	_stats.m_count		= 0;
+	_stats.m_totalTime	= 0.0;
+	_stats.m_selfTime	= 0.0;
+	_stats.m_minTime	= 0.0;
+	_stats.m_maxTime	= 0.0;
+	sketchInit(_stats.m_times);
+}
+
+static void addScopeTime(ScopeStats& _stats, double _time, double _selfTime)
+{
+	if (!_stats.m_count || (_stats.m_minTime > _time))
+		_stats.m_minTime = _time;
+	if (_stats.m_maxTime < _time)
+		_stats.m_maxTime = _time;
+	_stats.m_count++;
+	_stats.m_totalTime	+= _time;
+	_stats.m_selfTime	+= _selfTime;
+	sketchAdd(_stats.m_times, _time);
+}
+
+static void mergeScopeStats(ScopeStats& _stats, const ScopeStats& _other)
+{
+	_stats.m_minTime	= std::min(_stats.m_minTime, _other.m_minTime);
+	_stats.m_maxTime	= std::max(_stats.m_maxTime, _other.m_maxTime);
+	_stats.m_count		+= _other.m_count;
+	_stats.m_totalTime	+= _other.m_totalTime;
+	_stats.m_selfTime	+= _other.m_selfTime;
+	sketchMerge(_stats.m_times, _other.m_times);
+}
+
+static void collectCallPaths(WorkerStats& _worker, ProfilerFrame* _frame, uint64_t _frequency)
+{
+	if (!_frame->m_numScopes)
+		return;
+
+	_worker.m_scopePaths.resize(_frame->m_numScopes);
+	rprofAddToCallTree(_worker.m_callTree, _frame, &_worker.m_scopePaths[0]);
+
+	const ProfilerCallPath* paths;
+	uint32_t numPaths = rprofGetCallPaths(_worker.m_callTree, &paths, 0);
+	while (_worker.m_pathStats.size() < numPaths)
+	{
+		_worker.m_pathStats.push_back(ScopeStats());
+		initScopeStats(_worker.m_pathStats.back(), std::string());
+	}
+
+	for (uint32_t i=0; i<_frame->m_numScopes; ++i)
+	{
+		const ProfilerScope& scope = _frame->m_scopes[i];
+		addScopeTime(_worker.m_pathStats[_worker.m_scopePaths[i]],	clockToMs(scope.m_stats->m_inclusiveTime, _frequency),
+																	clockToMs(scope.m_stats->m_exclusiveTime, _frequency));
+	}
+}
+
+static void collectFrameStats(ProfilerFrame* _frame, uint32_t _index, uint32_t _worker, void* _userData)
+{
+	CollectContext& context = *(CollectContext*)_userData;
+	WorkerStats& worker = context.m_workers[_worker];
+
+	uint64_t frequency = _frame->m_CPUFrequency ? _frame->m_CPUFrequency : context.m_clockFrequency;
+
+	FrameStats& frameStats = context.m_frames[_index];
+	frameStats.m_index			= _index;
+	frameStats.m_time			= clockToMs(_frame->m_endtime - _frame->m_startTime, frequency);
+	frameStats.m_numScopes		= _frame->m_numScopes;
+	frameStats.m_numThreads		= _frame->m_numThreads;
+	frameStats.m_topScopeTime	= 0.0;
+	context.m_loaded[_index]	= 1;
+
+	size_t frameSize;
+	const void* frameData = rprofGetCaptureFrameData(context.m_capture, _index, &frameSize);
+	ProfilerFrameSummary summary;
+	if (rprofLoadSummary(&summary, frameData, frameSize) && summary.m_numTopScopes)
+	{
+		frameStats.m_topScope		= summary.m_topScopes[0].m_name;
+		frameStats.m_topScopeTime	= clockToMs(summary.m_topScopes[0].m_exclusiveTime, frequency);
+	}
+
+	worker.m_pointerIndices.clear();
+	for (uint32_t i=0; i<_frame->m_numScopes; ++i)
+	{
+		const ProfilerScope& scope = _frame->m_scopes[i];
+
+		uint32_t index;
+		std::unordered_map<const char*, uint32_t>::iterator it = worker.m_pointerIndices.find(scope.m_name);
+		if (it != worker.m_pointerIndices.end())
+			index = it->second;
+		else
+		{
+			std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> name = worker.m_nameIndices.insert(std::make_pair(std::string(scope.m_name), (uint32_t)worker.m_scopes.size()));
+			if (name.second)
+			{
+				worker.m_scopes.push_back(ScopeStats());
+				initScopeStats(worker.m_scopes.back(), name.first->first);
+			}
+			index = name.first->second;
+			worker.m_pointerIndices[scope.m_name] = index;
+		}
+
+		addScopeTime(worker.m_scopes[index],	clockToMs(scope.m_stats->m_inclusiveTime, frequency),
+												clockToMs(scope.m_stats->m_exclusiveTime, frequency));
+	}
+
+	if (context.m_callPaths)
+		collectCallPaths(worker, _frame, frequency);
+}
+
+bool collectCaptureStats(const char* _path, CaptureStats& _stats, uint32_t _numThreads, bool _callPaths)
+{
+	_stats.m_frames.clear();
+	_stats.m_scopes.clear();
+	_stats.m_callPaths.clear();
+	_stats.m_clockFrequency	= 0;
+	_stats.m_numScopes		= 0;
+	_stats.m_maxThreads		= 0;
+	_stats.m_minFrameTime	= 0.0;
+	_stats.m_maxFrameTime	= 0.0;
+	_stats.m_totalFrameTime	= 0.0;
+
+	ProfilerCapture* capture = rprofOpenCapture(_path);
+	if (!capture)
+		return false;
+
+	uint32_t numFrames = rprofGetCaptureFrameCount(capture);
+	_stats.m_clockFrequency = rprofGetCaptureClockFrequency(capture);
+
+	CollectContext context;
+	context.m_capture			= capture;
+	context.m_clockFrequency	= _stats.m_clockFrequency;
+	context.m_callPaths			= _callPaths;
+	context.m_frames.resize(numFrames);
+	context.m_loaded.resize(numFrames, 0);
+	context.m_workers.resize(std::max(_numThreads, 1u));
+	for (size_t i=0; i<context.m_workers.size(); ++i)
+		context.m_workers[i].m_callTree = _callPaths ? rprofCreateCallTree() : 0;
+
+	rprofProcessCaptureFrames(capture, collectFrameStats, &context, (uint32_t)context.m_workers.size());
+	rprofCloseCapture(capture);
+
+	_stats.m_frames.reserve(numFrames);
+	for (uint32_t i=0; i<numFrames; ++i)
+	{
+		if (!context.m_loaded[i])
+			continue;
+
+		const FrameStats& frameStats = context.m_frames[i];
+		if (_stats.m_frames.empty() || (_stats.m_minFrameTime > frameStats.m_time))
+			_stats.m_minFrameTime = frameStats.m_time;
+		if (_stats.m_maxFrameTime < frameStats.m_time)
+			_stats.m_maxFrameTime = frameStats.m_time;
+		if (_stats.m_maxThreads < frameStats.m_numThreads)
+			_stats.m_maxThreads = frameStats.m_numThreads;
+		_stats.m_totalFrameTime	+= frameStats.m_time;
+		_stats.m_numScopes		+= frameStats.m_numScopes;
+		_stats.m_frames.push_back(frameStats);
+	}
+
+	// merge per worker scope stats
+	std::unordered_map<std::string, uint32_t> nameIndices;
+	for (size_t i=0; i<context.m_workers.size(); ++i)
+	{
+		const std::vector<ScopeStats>& scopes = context.m_workers[i].m_scopes;
+		for (size_t j=0; j<scopes.size(); ++j)
+		{
+			const ScopeStats& scope = scopes[j];
+
+			std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> name = nameIndices.insert(std::make_pair(scope.m_name, (uint32_t)_stats.m_scopes.size()));
+			if (name.second)
+			{
+				_stats.m_scopes.push_back(scope);
+				continue;
+			}
+
+			mergeScopeStats(_stats.m_scopes[name.first->second], scope);
+		}
+	}
+
+	// merge per worker call paths, parent paths precede their children
+	std::unordered_map<std::string, uint32_t> pathIndices;
+	std::vector<std::string> pathNames;
+	for (size_t i=0; i<context.m_workers.size(); ++i)
+	{
+		WorkerStats& worker = context.m_workers[i];
+		if (!worker.m_callTree)
+			continue;
+
+		const ProfilerCallPath* paths;
+		uint32_t numPaths = rprofGetCallPaths(worker.m_callTree, &paths, 0);
+
+		pathNames.resize(numPaths);
+		for (uint32_t j=0; j<numPaths; ++j)
+		{
+			pathNames[j].clear();
+			if (paths[j].m_parent != RPROF_CALL_PATH_ROOT)
+			{
+				pathNames[j] = pathNames[paths[j].m_parent];
+				pathNames[j] += ';';
+			}
+			pathNames[j] += paths[j].m_name;
+
+			std::pair<std::unordered_map<std::string, uint32_t>::iterator, bool> name = pathIndices.insert(std::make_pair(pathNames[j], (uint32_t)_stats.m_callPaths.size()));
+			if (name.second)
+			{
+				_stats.m_callPaths.push_back(worker.m_pathStats[j]);
+				_stats.m_callPaths.back().m_name = pathNames[j];
+			}
+			else
+				mergeScopeStats(_stats.m_callPaths[name.first->second], worker.m_pathStats[j]);
+		}
+
+		rprofDestroyCallTree(worker.m_callTree);
+	}
+
+	std::sort(_stats.m_scopes.begin(), _stats.m_scopes.end(), ScopeSelfTimeOrder());
+	std::sort(_stats.m_callPaths.begin(), _stats.m_callPaths.end(), ScopeSelfTimeOrder());
+	return true;
+}
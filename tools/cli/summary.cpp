@@ -0,0 +1,125 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+static void printSummaryText(const char* _path, const CaptureStats& _stats, const Options& _options)
+{
+	uint32_t numFrames = (uint32_t)_stats.m_frames.size();
+
+	printf("%s\n", _path);
+	printf("  frames %u, scopes %llu, threads %u, clock %.3f MHz\n",
+		numFrames, (unsigned long long)_stats.m_numScopes, _stats.m_maxThreads, (double)_stats.m_clockFrequency / 1000000.0);
+	printf("  frame ms  min %.3f  avg %.3f  max %.3f  total %.3f\n",
+		_stats.m_minFrameTime, numFrames ? _stats.m_totalFrameTime / numFrames : 0.0, _stats.m_maxFrameTime, _stats.m_totalFrameTime);
+
+	if (_options.m_frames)
+	{
+		printf("\n  %6s %10s %8s %8s  %s\n", "frame", "ms", "scopes", "threads", "top scope");
+		for (uint32_t i=0; i<numFrames; ++i)
+		{
+			const FrameStats& frame = _stats.m_frames[i];
+			printf("  %6u %10.3f %8u %8u  ", frame.m_index, frame.m_time, frame.m_numScopes, frame.m_numThreads);
+			if (frame.m_topScope.empty())
+				printf("-\n");
+			else
+				printf("%s (%.3f ms)\n", frame.m_topScope.c_str(), frame.m_topScopeTime);
+		}
+	}
+
+	uint32_t numScopes = (uint32_t)_stats.m_scopes.size();
+	if (_options.m_top && (numScopes > _options.m_top))
+		numScopes = _options.m_top;
+
+	printf("\n  %-32s %10s %12s %12s %10s %10s %10s\n", "scope", "count", "total ms", "self ms", "min ms", "max ms", "avg ms");
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		const ScopeStats& scope = _stats.m_scopes[i];
+		printf("  %-32s %10llu %12.3f %12.3f %10.3f %10.3f %10.3f\n", scope.m_name.c_str(), (unsigned long long)scope.m_count,
+			scope.m_totalTime, scope.m_selfTime, scope.m_minTime, scope.m_maxTime, scope.m_totalTime / (double)scope.m_count);
+	}
+	printf("\n");
+}
+
+static void printSummaryJson(const char* _path, const CaptureStats& _stats, const Options& _options)
+{
+	uint32_t numFrames = (uint32_t)_stats.m_frames.size();
+
+	printf("{\"path\":");
+	jsonString(stdout, _path);
+	printf(",\"frames\":%u,\"scopes\":%llu,\"threads\":%u,\"clockFrequency\":%llu",
+		numFrames, (unsigned long long)_stats.m_numScopes, _stats.m_maxThreads, (unsigned long long)_stats.m_clockFrequency);
+	printf(",\"frameTime\":{\"min\":%.6f,\"avg\":%.6f,\"max\":%.6f,\"total\":%.6f}",
+		_stats.m_minFrameTime, numFrames ? _stats.m_totalFrameTime / numFrames : 0.0, _stats.m_maxFrameTime, _stats.m_totalFrameTime);
+
+	if (_options.m_frames)
+	{
+		printf(",\"frameList\":[");
+		for (uint32_t i=0; i<numFrames; ++i)
+		{
+			const FrameStats& frame = _stats.m_frames[i];
+			printf("%s{\"frame\":%u,\"time\":%.6f,\"scopes\":%u,\"threads\":%u", i ? "," : "", frame.m_index, frame.m_time, frame.m_numScopes, frame.m_numThreads);
+			if (!frame.m_topScope.empty())
+			{
+				printf(",\"topScope\":");
+				jsonString(stdout, frame.m_topScope.c_str());
+				printf(",\"topScopeTime\":%.6f", frame.m_topScopeTime);
+			}
+			printf("}");
+		}
+		printf("]");
+	}
+
+	uint32_t numScopes = (uint32_t)_stats.m_scopes.size();
+	if (_options.m_top && (numScopes > _options.m_top))
+		numScopes = _options.m_top;
+
+	printf(",\"scopeStats\":[");
+	for (uint32_t i=0; i<numScopes; ++i)
+	{
+		const ScopeStats& scope = _stats.m_scopes[i];
+		printf("%s{\"name\":", i ? "," : "");
+		jsonString(stdout, scope.m_name.c_str());
+		printf(",\"count\":%llu,\"total\":%.6f,\"self\":%.6f,\"min\":%.6f,\"max\":%.6f,\"avg\":%.6f}", (unsigned long long)scope.m_count,
+			scope.m_totalTime, scope.m_selfTime, scope.m_minTime, scope.m_maxTime, scope.m_totalTime / (double)scope.m_count);
+	}
+	printf("]}");
+}
+
+int commandSummary(const Options& _options)
+{
+	int result = 0;
+
+	if (_options.m_json)
+		printf("[");
+
+	bool first = true;
+	for (size_t i=0; i<_options.m_files.size(); ++i)
+	{
+		const char* path = _options.m_files[i];
+
+		CaptureStats stats;
+		if (!collectCaptureStats(path, stats, _options.m_threads, false))
+		{
+			fprintf(stderr, "rprof-cli: can not open capture '%s'\n", path);
+			result = 2;
+			continue;
+		}
+
+		if (_options.m_json)
+		{
+			if (!first)
+				printf(",\n");
+			printSummaryJson(path, stats, _options);
+		}
+		else
+			printSummaryText(path, stats, _options);
+		first = false;
+	}
+
+	if (_options.m_json)
+		printf("]\n");
+	return result;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2025 Milos Tosic. All Rights Reserved.
+ * License: http://www.opensource.org/licenses/BSD-2-Clause
+ */
+
+#include "cli.h"
+
+int commandTrace(const Options& _options)
+{
+	if (_options.m_files.size() != 1)
+	{
+		fprintf(stderr, "rprof-cli: trace takes exactly one capture file\n");
+		return 1;
+	}
+
+	const char* path = _options.m_files[0];
+	ProfilerCapture* capture = rprofOpenCapture(path);
+	if (!capture)
+	{
+		fprintf(stderr, "rprof-cli: can not open capture '%s'\n", path);
+		return 2;
+	}
+
+	FILE* out = _options.m_output ? fopen(_options.m_output, "wb") : stdout;
+	if (!out)
+	{
+		fprintf(stderr, "rprof-cli: can not create '%s'\n", _options.m_output);
+		rprofCloseCapture(capture);
+		return 2;
+	}
+
+	int result = rprofExportChromeTrace(capture, _options.m_firstFrame, _options.m_numFrames, writeFile, out) ? 0 : 2;
+	if (out != stdout)
+		result = fclose(out) ? 2 : result;
+	else
+		fflush(stdout);
+
+	if (result)
+		fprintf(stderr, "rprof-cli: failed writing trace of '%s'\n", path);
+
+	rprofCloseCapture(capture);
+	return result;
+}
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <vector>
 #include <algorithm>
 
@@ -37,8 +38,7 @@ EM_JS(void,	resizeCanvas, (),		{ js_resizeCanvas(); });
 struct FrameInfo
 {
 	float		m_time;
-	uint32_t	m_offset;
-	uint32_t	m_size;
+	uint32_t	m_frame;
 };
 
 GLFWwindow*				g_window;
@@ -46,14 +46,19 @@ ImGuiContext*			g_imgui = 0;
 ImPlotContext*			g_plot = 0;
 int						g_multi = -1;
 ProfilerFrame			g_frame;
-char					g_fileName[1024];
+uint32_t				g_frameIndex = 0;
+ProfilerFrame			g_baseFrame;		// baseline of 'Frame diff', loaded to its own arena
+int						g_baseFrameIndex = -1;
+ProfilerCapture*		g_capture = 0;
+ProfilerFrameArena*		g_arena = 0;
+ProfilerFrameArena*		g_baseArena = 0;
 std::vector<FrameInfo>	g_frameInfos;
 
 struct SortFrameInfoChrono
 {
 	bool operator()(const FrameInfo& a, const FrameInfo& b) const
 	{
-		if (a.m_offset < b.m_offset) return true;
+		if (a.m_frame < b.m_frame) return true;
 		return false;
 	}
 } customChrono;
@@ -76,7 +81,8 @@ struct SortFrameInfoAsc
 	}
 } customAsc;
 
-void profilerFrameLoad(const char* _name, uint32_t _offset = 0, uint32_t _size = 0);
+void profilerFrameLoad(uint32_t _frame);
+void profilerBaseFrameLoad(uint32_t _frame);
 
 void rprofDrawTutorial(bool _multi)
 {
@@ -104,6 +110,7 @@ void rprofDrawTutorial(bool _multi)
 	ImGui::Separator();
 	ImGui::Text("If capture is multi-frame, a 'Frame navigator' window will appear.");
 	ImGui::Text("Clicking on a frame will load the profiling data for that particular frame.");
+	ImGui::Text("'Set as diff baseline' compares frames loaded afterwards to the current one in 'Frame diff' window.");
 
 	ImGui::End();
 }
@@ -143,6 +150,16 @@ void rprofDrawFrameNavigation(FrameInfo* _infos, uint32_t _numInfos)
 	ImGui::RadioButton("Descending", &sortKind, 1);
 	ImGui::SameLine();
 	ImGui::RadioButton("Ascending", &sortKind, 2);
+	ImGui::SameLine();
+
+	int frame = (int)g_frameIndex;
+	ImGui::PushItemWidth(100.0f);
+	if (ImGui::InputInt("Frame", &frame) && (frame >= 0) && ((uint32_t)frame < _numInfos))
+		profilerFrameLoad((uint32_t)frame);
+	ImGui::PopItemWidth();
+	ImGui::SameLine();
+	if (ImGui::Button("Set as diff baseline"))
+		profilerBaseFrameLoad(g_frameIndex);
 	ImGui::Separator();
 
 	switch (sortKind)
@@ -177,7 +194,7 @@ void rprofDrawFrameNavigation(FrameInfo* _infos, uint32_t _numInfos)
 
 	if (ImGui::IsMouseClicked(0) && (idx != -1))
 	{
-		profilerFrameLoad(g_fileName, _infos[idx].m_offset, _infos[idx].m_size);
+		profilerFrameLoad(_infos[idx].m_frame);
 	}
 
 	ImGui::EndChild();
@@ -233,93 +250,71 @@ int init()
 
 void quit()
 {
-	rprofRelease(&g_frame);
+	if (g_arena)
+		rprofDestroyFrameArena(g_arena);
+	if (g_baseArena)
+		rprofDestroyFrameArena(g_baseArena);
+	if (g_capture)
+		rprofCloseCapture(g_capture);
 	glfwTerminate();
 }
 
-void profilerFrameLoad(const char* _name, uint32_t _offset, uint32_t _size)
+void profilerFrameLoad(uint32_t _frame)
 {
-	FILE* file = fopen(_name, "rb");
-	if (file)
-	{
-		long csize = _size;
-
-		if (!csize)
-		{
-			fseek(file, 0, SEEK_END);
-			csize = ftell(file);
-			fseek(file, 0, SEEK_SET);
-		}
-		else
-			fseek(file, _offset + 4, SEEK_SET);
-
-		static const size_t maxDecompSize = 4 * 1024 * 1024;
-		uint8_t* compBuffer		= new uint8_t[csize];
-		uint8_t* decompBuffer	= new uint8_t[maxDecompSize];
-		uint8_t* bufferReadPtr	= decompBuffer;
-
-		fread(compBuffer, 1, csize, file);
-		rprofLoad(&g_frame, compBuffer, csize);
-		delete[] decompBuffer;
-		delete[] compBuffer;
-
-		fclose(file);
-	}
+	// frames are loaded to the same memory when scrubbing
+	if (!g_arena)
+		g_arena = rprofCreateFrameArena();
+
+	if (!rprofLoadCaptureFrameToArena(g_capture, _frame, &g_frame, g_arena))
+		memset(&g_frame, 0, sizeof(g_frame));
+	g_frameIndex = _frame;
 }
 
-void profilerFrameLoadMulti(const char* _name)
+void profilerBaseFrameLoad(uint32_t _frame)
 {
-	strcpy(g_fileName, _name);
-	FILE* file = fopen(_name, "rb");
-	if (file)
-	{
-		fseek(file, 0, SEEK_END);
-		long fileSize = ftell(file);
-		fseek(file, 0, SEEK_SET);
-
-		uint8_t* fileBuffer = new uint8_t[fileSize];
-		fread(fileBuffer, 1, fileSize, file);
-		fclose(file);
-
-		uint32_t offset = 4;
-		while (offset < (uint32_t)fileSize)
-		{
-			FrameInfo info;
-			info.m_offset = offset;
-
-			uint32_t frameSize = *reinterpret_cast<uint32_t*>(&fileBuffer[offset]);
-			offset += 4;
+	if (!g_baseArena)
+		g_baseArena = rprofCreateFrameArena();
 
-			rprofLoadTimeOnly(&info.m_time, &fileBuffer[offset], frameSize);
+	g_baseFrameIndex = (int)_frame;
+	if (!rprofLoadCaptureFrameToArena(g_capture, _frame, &g_baseFrame, g_baseArena))
+		g_baseFrameIndex = -1;
+}
 
-			info.m_size = frameSize;
-			g_frameInfos.push_back(info);															
+void profilerFrameLoadMulti()
+{
+	const ProfilerFrameIndex* index	= rprofGetCaptureFrameIndex(g_capture);
+	uint64_t frequency				= rprofGetCaptureClockFrequency(g_capture);
+	uint32_t numFrames				= rprofGetCaptureFrameCount(g_capture);
 
-			rprofRelease(&g_frame);
-			offset += frameSize;
-		}
-		delete[] fileBuffer;
+	g_frameInfos.clear();
+	for (uint32_t i=0; i<numFrames; ++i)
+	{
+		FrameInfo info;
+		info.m_time		= rprofClock2ms(index[i].m_endTime - index[i].m_startTime, frequency);
+		info.m_frame	= i;
+		g_frameInfos.push_back(info);
 	}
-
-	profilerFrameLoad(g_fileName, g_frameInfos[0].m_offset, g_frameInfos[0].m_size);
 }
 
 void profilerFrameLoadCallback(const char* _name)
 {
-	FILE* file = fopen(_name, "rb");
-	if (file)
+	if (g_capture)
+		rprofCloseCapture(g_capture);
+
+	g_capture = rprofOpenCapture(_name);
+	if (!g_capture)
 	{
-		uint32_t sig;
-		fread(&sig, 1, 4, file);
-		fclose(file);
+		printf("ERROR: Failed to open capture!");
+		return;
+	}
 
-		g_multi = sig == 0x23232323 ? 1 : 0;
+	g_multi = rprofGetCaptureFrameCount(g_capture) > 1 ? 1 : 0;
+	g_baseFrameIndex = -1;
 
-		if (g_multi)
-			profilerFrameLoadMulti(_name);
-		else
-			profilerFrameLoad(_name);
-	}
+	if (g_multi)
+		profilerFrameLoadMulti();
+
+	profilerFrameLoad(0);
 }
 
 void profilerFrameLoadError(const char* _name)
@@ -352,6 +347,9 @@ void loop()
 		rprofDrawFrame(&g_frame, 0, 0, false, g_multi == 1);
 
 		rprofDrawStats(&g_frame, g_multi == 1);
+
+		if (g_baseFrameIndex != -1)
+			rprofDrawFrameDiff(&g_baseFrame, &g_frame, g_multi == 1);
 	}
 
 	ImGui::Render();